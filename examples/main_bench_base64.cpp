@@ -0,0 +1,179 @@
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// make sure the path is included correct
+#include "small/include/base64.h"
+
+
+// result of one measurement
+struct bench_result
+{
+    const char* variant;
+    const char* direction;
+    const char* container;
+    const char* impl;
+    const char* cache;
+    size_t      payload;
+    size_t      iterations;
+    double      seconds;
+};
+
+// what the compiler should not remove
+static size_t g_sink = 0;
+
+// large buffer written before each cold call to push the data out of the caches
+static std::vector<char> g_evict;
+static void evict_caches()
+{
+    for ( size_t i = 0; i < g_evict.size(); i += 64 )
+        g_evict[i] = (char)(g_evict[i] + 1);
+    g_sink += (size_t)g_evict[g_evict.size() / 2];
+}
+
+// time function, warm runs it once before the measurement, cold evicts the caches before each call (not timed)
+template<typename _Function>
+static double measure( bool cold, size_t iterations, _Function function )
+{
+    if ( !cold )
+    {
+        function();
+        auto start = std::chrono::steady_clock::now();
+        for ( size_t i = 0; i < iterations; ++i )
+            function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    double seconds = 0;
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        evict_caches();
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        seconds += elapsed.count();
+    }
+    return seconds;
+}
+
+
+// encode and decode with each container for one variant
+template<typename _Variant>
+static void bench_variant( const char* variant, const std::string& data, size_t payload, const char* impl, std::vector<bench_result>& results )
+{
+    const char* src = data.data();
+    std::string b64 = small::tobase64_s<_Variant>( src, payload );
+
+    // about 64MB processed for each warm measurement, fewer calls when cold
+    size_t warm_iterations = std::max<size_t>( 1, ((size_t)64 << 20) / std::max<size_t>( payload, 1 ) );
+    warm_iterations = std::min<size_t>( warm_iterations, 1000000 );
+    size_t cold_iterations = std::min<size_t>( warm_iterations, 16 );
+
+    for ( int c = 0; c < 2; ++c )
+    {
+        bool cold = c == 1;
+        const char* cache = cold ? "cold" : "warm";
+        size_t iterations = cold ? cold_iterations : warm_iterations;
+
+        results.push_back( { variant, "encode", "string", impl, cache, payload, iterations,
+                             measure( cold, iterations, [&]() { g_sink += small::tobase64_s<_Variant>( src, payload ).size(); } ) } );
+        results.push_back( { variant, "encode", "vector", impl, cache, payload, iterations,
+                             measure( cold, iterations, [&]() { g_sink += small::tobase64_v<_Variant>( src, payload ).size(); } ) } );
+        results.push_back( { variant, "encode", "buffer", impl, cache, payload, iterations,
+                             measure( cold, iterations, [&]() { g_sink += small::tobase64_b<_Variant>( src, payload ).size(); } ) } );
+
+        results.push_back( { variant, "decode", "string", impl, cache, payload, iterations,
+                             measure( cold, iterations, [&]() { g_sink += small::frombase64_s<_Variant>( b64.data(), b64.size() ).size(); } ) } );
+        results.push_back( { variant, "decode", "vector", impl, cache, payload, iterations,
+                             measure( cold, iterations, [&]() { g_sink += small::frombase64_v<_Variant>( b64.data(), b64.size() ).size(); } ) } );
+        results.push_back( { variant, "decode", "buffer", impl, cache, payload, iterations,
+                             measure( cold, iterations, [&]() { g_sink += small::frombase64_b<_Variant>( b64.data(), b64.size() ).size(); } ) } );
+    }
+}
+
+
+// print as csv or json (gb_per_second is for the decoded payload size in both directions)
+static void print_results( const std::vector<bench_result>& results, bool json )
+{
+    if ( json )
+        std::cout << "[\n";
+    else
+        std::cout << "variant,direction,container,impl,cache,payload_bytes,iterations,ns_per_call,gb_per_second\n";
+
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        const bench_result& r = results[i];
+        double seconds = r.seconds > 0 ? r.seconds : 1e-9;
+        double ns_per_call = seconds * 1e9 / (double)r.iterations;
+        double gb_per_second = (double)r.payload * (double)r.iterations / seconds / 1e9;
+
+        char line[512];
+        if ( json )
+            snprintf( line, sizeof( line ), "  { \"variant\": \"%s\", \"direction\": \"%s\", \"container\": \"%s\", \"impl\": \"%s\", \"cache\": \"%s\", "
+                                            "\"payload_bytes\": %zu, \"iterations\": %zu, \"ns_per_call\": %.1f, \"gb_per_second\": %.4f }%s\n",
+                      r.variant, r.direction, r.container, r.impl, r.cache, r.payload, r.iterations, ns_per_call, gb_per_second, i + 1 < results.size() ? "," : "" );
+        else
+            snprintf( line, sizeof( line ), "%s,%s,%s,%s,%s,%zu,%zu,%.1f,%.4f\n",
+                      r.variant, r.direction, r.container, r.impl, r.cache, r.payload, r.iterations, ns_per_call, gb_per_second );
+        std::cout << line;
+    }
+
+    if ( json )
+        std::cout << "]\n";
+}
+
+
+// base64 throughput and latency for payloads from 8 bytes to max_size (x8 each step), for string, vector and
+// buffer, warm and cold cache, with the best simd kernels and with the scalar reference (simd level none)
+// usage: main_bench_base64 [max_size_in_bytes (default 1GB)] [csv|json (default csv)]
+int main( int argc, char* argv[] )
+{
+    size_t max_size = argc > 1 ? (size_t)strtoull( argv[1], nullptr, 10 ) : (size_t)1024 * 1024 * 1024;
+    bool json       = argc > 2 && strcmp( argv[2], "json" ) == 0;
+    if ( max_size < 8 )
+        max_size = 8;
+
+    // bigger than the last level cache
+    g_evict.resize( (size_t)32 << 20, 1 );
+
+    std::string data( max_size, '\0' );
+    unsigned int seed = 12345;
+    for ( auto& ch : data )
+    {
+        seed = seed * 1103515245 + 12345;
+        ch = (char)(seed >> 16);
+    }
+
+    const small::cpu::EnumSimdLevel detected = small::cpu::detect_simd_level();
+    const char* simd_name = detected == small::cpu::EnumSimdLevel::kSimd_AVX512 ? "avx512" :
+                            detected == small::cpu::EnumSimdLevel::kSimd_AVX2   ? "avx2"   :
+                            detected == small::cpu::EnumSimdLevel::kSimd_SSSE3  ? "ssse3"  : "none";
+
+    std::vector<bench_result> results;
+    for ( size_t payload = 8; payload <= max_size; payload *= 8 )
+    {
+        for ( int s = 0; s < 2; ++s )
+        {
+            bool scalar = s == 1;
+            if ( scalar && detected == small::cpu::EnumSimdLevel::kSimd_None )
+                continue;
+            small::cpu::set_simd_level( scalar ? small::cpu::EnumSimdLevel::kSimd_None : detected );
+            const char* impl = scalar ? "scalar" : simd_name;
+
+            bench_variant<small::base64::standard>  ( "standard",  data, payload, impl, results );
+            bench_variant<small::base64::url_nopad> ( "url_nopad", data, payload, impl, results );
+            bench_variant<small::base64::mime>      ( "mime",      data, payload, impl, results );
+        }
+    }
+    small::cpu::set_simd_level( detected );
+
+    print_results( results, json );
+    return g_sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+// make sure the path is included correct
+#include "small/include/buffer.h"
+
+
+// append throughput for each growth policy
+// usage: main_bench_buffer [max_size_in_bytes (default 1GB)] [piece_size (default 1024)]
+int main( int argc, char* argv[] )
+{
+    size_t max_size     = argc > 1 ? (size_t)strtoull( argv[1], nullptr, 10 ) : (size_t)1024 * 1024 * 1024;
+    size_t piece_size   = argc > 2 ? (size_t)strtoull( argv[2], nullptr, 10 ) : 1024;
+    if ( piece_size == 0 )
+        piece_size = 1;
+
+    std::vector<char> piece( piece_size, 'a' );
+
+    struct policy { small::EnumBufferGrowth growth; const char* name; };
+    const policy policies[] =
+    {
+        { small::EnumBufferGrowth::kGrowth_Chunk,       "chunk"     },
+        { small::EnumBufferGrowth::kGrowth_Geometric,   "geometric" },
+        { small::EnumBufferGrowth::kGrowth_Double,      "double"    },
+        { small::EnumBufferGrowth::kGrowth_Huge,        "huge"      },
+    };
+
+    std::cout << "policy,payload_bytes,piece_bytes,seconds,mb_per_second\n";
+    for ( size_t payload = 1024; payload <= max_size; payload *= 4 )
+    {
+        for ( auto& p : policies )
+        {
+            auto start = std::chrono::steady_clock::now();
+            {
+                small::buffer b;
+                b.set_growth( p.growth );
+                for ( size_t written = 0; written < payload; written += piece_size )
+                {
+                    b.append( piece.data(), piece_size );
+                }
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double seconds = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+
+            std::cout << p.name << "," << payload << "," << piece_size << "," << seconds << "," << (payload / (1024.0 * 1024.0)) / seconds << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <chrono>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// make sure the path is included correct
+#include "small/include/flat_map.h"
+#include "small/include/icase.h"
+#include "small/include/util.h"
+
+
+// what the compiler should not remove
+static size_t g_sink = 0;
+
+// seconds for function
+template<typename _Function>
+static double measure( _Function function )
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() > 0 ? elapsed.count() : 1e-9;
+}
+
+static void print( const char* container, const char* op, size_t entries, double seconds )
+{
+    std::cout << container << "," << op << "," << entries << "," << seconds * 1e9 / (double)entries << "\n";
+}
+
+
+// insert all keys, look up all of them (hit), look up keys that are not there (miss), erase all
+// lookups go in a different order than the inserts
+template<typename _Map>
+static void bench_map( const char* container, const std::vector<std::string>& keys, const std::vector<std::string>& lookup, const std::vector<std::string>& missing )
+{
+    _Map m;
+    print( container, "insert", keys.size(), measure( [&]() {
+        for ( size_t i = 0; i < keys.size(); ++i )
+            m.insert( { keys[i], (int)i } );
+    } ) );
+
+    print( container, "hit", lookup.size(), measure( [&]() {
+        for ( auto& k : lookup )
+            g_sink += m.find( k )->second;
+    } ) );
+
+    print( container, "miss", missing.size(), measure( [&]() {
+        for ( auto& k : missing )
+            g_sink += m.find( k ) == m.end() ? 1 : 0;
+    } ) );
+
+    print( container, "erase", lookup.size(), measure( [&]() {
+        for ( auto& k : lookup )
+            g_sink += m.erase( k );
+    } ) );
+}
+
+// flat_map lookups with string_view (no temporary key)
+template<typename _Map>
+static void bench_view_lookup( const char* container, const std::vector<std::string>& keys, const std::vector<std::string>& lookup )
+{
+    _Map m;
+    m.reserve( keys.size() );
+    for ( size_t i = 0; i < keys.size(); ++i )
+        m.try_emplace( keys[i], (int)i );
+
+    std::vector<std::string_view> views( lookup.begin(), lookup.end() );
+    print( container, "hit_view", views.size(), measure( [&]() {
+        for ( auto& v : views )
+            g_sink += m.find( v )->second;
+    } ) );
+}
+
+
+// case insensitive lookups with keys in another case (std::map with icasecmp against icase_flat_map)
+static void bench_icase_lookup( const std::vector<std::string>& keys, const std::vector<std::string>& lookup )
+{
+    std::vector<std::string> upper( lookup.begin(), lookup.end() );
+    for ( auto& k : upper )
+        for ( auto& ch : k )
+            ch = (char)toupper( (unsigned char)ch );
+
+    std::map<std::string, int, small::icasecmp> tree;
+    small::icase_flat_map<std::string, int> flat;
+    for ( size_t i = 0; i < keys.size(); ++i )
+    {
+        tree[keys[i]] = (int)i;
+        flat[keys[i]] = (int)i;
+    }
+
+    print( "std::map icasecmp", "hit_icase", upper.size(), measure( [&]() {
+        for ( auto& k : upper )
+            g_sink += tree.find( k )->second;
+    } ) );
+    print( "small::icase_flat_map", "hit_icase", upper.size(), measure( [&]() {
+        for ( auto& k : upper )
+            g_sink += flat.find( k )->second;
+    } ) );
+}
+
+
+// insert, hit, miss and erase (ns per operation) for std::unordered_map and small::flat_map with
+// header / session like string keys, from 1K entries to max_entries (x4 each step), and case insensitive
+// lookups for std::map with icasecmp and icase_flat_map
+// usage: main_bench_flat_map [max_entries (default 1M)]
+int main( int argc, char* argv[] )
+{
+    size_t max_entries = argc > 1 ? (size_t)strtoull( argv[1], nullptr, 10 ) : (size_t)1024 * 1024;
+    if ( max_entries < 1024 )
+        max_entries = 1024;
+
+    std::mt19937_64 rng( 12345 );
+    std::cout << "container,op,entries,ns_per_op\n";
+    for ( size_t entries = 1024; entries <= max_entries; entries *= 4 )
+    {
+        std::vector<std::string> keys, missing;
+        keys.reserve( entries );
+        missing.reserve( entries );
+        char key[64];
+        for ( size_t i = 0; i < entries; ++i )
+        {
+            unsigned long long r = rng();
+            snprintf( key, sizeof( key ), "session-%016llx-%zu", r, i );
+            keys.push_back( key );
+            snprintf( key, sizeof( key ), "missing-%016llx-%zu", r, i );
+            missing.push_back( key );
+        }
+        std::vector<std::string> lookup = keys;
+        std::shuffle( lookup.begin(), lookup.end(), rng );
+
+        bench_map<std::unordered_map<std::string, int>>                         ( "std::unordered_map",         keys, lookup, missing );
+        bench_map<small::flat_map<std::string, int>>                            ( "small::flat_map",            keys, lookup, missing );
+        bench_map<small::flat_map<std::string, int, small::flat_quick_hash>>    ( "small::flat_map quick_hash", keys, lookup, missing );
+
+        bench_view_lookup<small::flat_map<std::string, int>>                    ( "small::flat_map",            keys, lookup );
+
+        bench_icase_lookup( keys, lookup );
+    }
+
+    return g_sink == 0 ? 1 : 0;
+}
@@ -18,6 +18,9 @@ int main()
     unsigned long long h1 = small::quick_hash( "some ", 5/*strlen*/, 0 );
     unsigned long long h2 = small::quick_hash( "text",  4/*strlen*/, h1 );
 
+    unsigned long long f64 = small::fast_hash64( "some text", 9/*strlen*/ );
+    small::hash128 f128 = small::fast_hash128( "some text", 9/*strlen*/, 12345/*seed*/ );
+
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "impl/base32_impl.h"
+
+#include "buffer.h"
+
+//
+// std::string b32 = small::tobase32_s( "hello world" );
+// std::string id  = small::tobase32_s<small::base32::hex_nopad>( data, data_length );
+//
+// std::string decoded = small::frombase32_s( b32 );
+//
+// size_t error_position = 0;
+// bool ok = small::frombase32( b32, &decoded, &error_position );    // strict
+//
+namespace small
+{
+    //
+    // encode in existing memory (no zero fill, no extra copy)
+    //
+
+    // encode into caller memory, returns chars written (0 if capacity is not enough)
+    template<typename _Variant = base32::standard>
+    inline size_t       tobase32_into               ( const char* src, const size_t& src_length, char* base32, const size_t& capacity )
+    {
+        size_t base32_size = base32::get_base32_size<_Variant>( src_length );
+        if ( base32 == nullptr || base32_size > capacity )
+            return 0;
+        base32::tobase32<_Variant>( base32, src, src_length );
+        return base32_size;
+    }
+
+    // encode at the end of buffer, returns chars added (0 if it could not be allocated)
+    template<typename _Variant = base32::standard>
+    inline size_t       tobase32_append             ( const char* src, const size_t& src_length, base_buffer& base32 )
+    {
+        size_t base32_size = base32::get_base32_size<_Variant>( src_length );
+        if ( base32_size == 0 )
+            return 0;
+        char* room = base32.prepare( base32_size );
+        if ( room == nullptr )
+            return 0;
+        base32::tobase32<_Variant>( room, src, src_length );
+        base32.commit( base32_size );
+        return base32_size;
+    }
+
+    // encode at the end of string, returns chars added
+    template<typename _Variant = base32::standard>
+    inline size_t       tobase32_append             ( const char* src, const size_t& src_length, std::string& base32 )
+    {
+        size_t base32_size = base32::get_base32_size<_Variant>( src_length );
+        if ( base32_size == 0 )
+            return 0;
+        size_t from = base32.size();
+#if defined(__cpp_lib_string_resize_and_overwrite)
+        base32.resize_and_overwrite( from + base32_size, [&]( char* p, size_t /*n*/ ) { base32::tobase32<_Variant>( p + from, src, src_length ); return from + base32_size; } );
+#else
+        base32.resize( from + base32_size );
+        base32::tobase32<_Variant>( base32.data() + from, src, src_length );
+#endif
+        return base32_size;
+    }
+
+    // encode at the end
+    template<typename _Variant = base32::standard, typename T>
+    inline size_t       tobase32_append             ( const std::string& src, T& base32 ) { return tobase32_append<_Variant>( src.c_str(), src.size(), base32 ); }
+
+
+
+
+    //
+    // implementations for common data
+    //
+
+    // tobase32 (variant base32::standard, hex, standard_nopad, hex_nopad)
+    template<typename _Variant = base32::standard, typename T>
+    inline void         tobase32                    ( const char* src, const size_t& src_length, T* base32 )
+    {
+        if ( base32 == nullptr )
+            return;
+
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> || std::is_same_v<std::string, T> )
+        {
+            // write directly at the end of the emptied buffer
+            base32->clear();
+            tobase32_append<_Variant>( src, src_length, *base32 );
+        }
+        else
+        {
+            base32->resize( base32::get_base32_size<_Variant>( src_length ) );
+            base32::tobase32<_Variant>( (char *)base32->data(), src, src_length );
+        }
+    }
+
+    // to base32
+    template<typename _Variant = base32::standard, typename T>
+    inline void         tobase32                    ( const std::string& src, T* base32 ) { return tobase32<_Variant>( src.c_str(), src.size(), base32 ); }
+
+
+    // frombase32 (strict), returns false on error, decoded contains what was decoded before the error
+    // error_position is the offset of the first rejected char, or the length when the data ends in the middle of a group
+    template<typename _Variant = base32::standard, typename T>
+    inline bool         frombase32                  ( const char* base32, const size_t& base32_length, T* decoded, size_t* error_position = nullptr )
+    {
+        size_t error = base32::npos;
+        if ( decoded != nullptr )
+        {
+            size_t decoded_size = base32::get_decodedbase32_size( base32_length );
+            if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+            {
+                decoded->clear();
+                char* room = decoded->prepare( decoded_size );
+                if ( room == nullptr )
+                    return false;
+                decoded->commit( base32::frombase32<_Variant>( room, base32, base32_length, &error ) );
+            }
+            else
+            {
+                decoded->resize( decoded_size );
+                size_t decoded_length = base32::frombase32<_Variant>( (char*)decoded->data(), base32, base32_length, &error );
+                decoded->resize( decoded_length );
+            }
+        }
+
+        if ( error_position )
+            *error_position = error;
+        return error == base32::npos;
+    }
+
+    // frombase32
+    template<typename _Variant = base32::standard, typename T>
+    inline bool         frombase32                  ( const std::string& base32, T* decoded, size_t* error_position = nullptr ) { return frombase32<_Variant>( base32.c_str(), base32.size(), decoded, error_position ); }
+
+
+
+
+
+    //////////////////////////////////////////////////////////////////////////
+    // as string
+    template<typename _Variant = base32::standard>
+    inline std::string  tobase32_s                  ( const char* src, const size_t& src_length ) { std::string base32; tobase32<_Variant>( src, src_length, &base32 ); return base32; }
+    template<typename _Variant = base32::standard>
+    inline std::string  tobase32_s                  ( const std::string&       src           ) { return tobase32_s<_Variant>( src.c_str(), src.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::string  tobase32_s                  ( const std::vector<char>& src           ) { return tobase32_s<_Variant>( src.data(),  src.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::string  tobase32_s                  ( const small::buffer&     src           ) { return tobase32_s<_Variant>( src.data(),  src.size() ); }
+
+    // as buffer vector<char>
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> tobase32_v             ( const char* src, const size_t& src_length ) { std::vector<char> base32; tobase32<_Variant>( src, src_length, &base32 ); return base32; }
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> tobase32_v             ( const std::string&       src           ) { return tobase32_v<_Variant>( src.c_str(), src.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> tobase32_v             ( const std::vector<char>& src           ) { return tobase32_v<_Variant>( src.data(),  src.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> tobase32_v             ( const small::buffer&     src           ) { return tobase32_v<_Variant>( src.data(),  src.size() ); }
+
+    // as buffer
+    template<typename _Variant = base32::standard>
+    inline small::buffer tobase32_b                 ( const char* src, const size_t& src_length ) { small::buffer base32; tobase32<_Variant>( src, src_length, &base32 ); return base32; }
+    template<typename _Variant = base32::standard>
+    inline small::buffer tobase32_b                 ( const std::string&       src           ) { return tobase32_b<_Variant>( src.c_str(), src.size() ); }
+    template<typename _Variant = base32::standard>
+    inline small::buffer tobase32_b                 ( const std::vector<char>& src           ) { return tobase32_b<_Variant>( src.data(),  src.size() ); }
+    template<typename _Variant = base32::standard>
+    inline small::buffer tobase32_b                 ( const small::buffer&     src           ) { return tobase32_b<_Variant>( src.data(),  src.size() ); }
+
+
+
+
+    // from base32_s
+    template<typename _Variant = base32::standard>
+    inline std::string  frombase32_s                ( const char* base32, const size_t& base32_length ) { std::string decoded; frombase32<_Variant>( base32, base32_length, &decoded ); return decoded; }
+    template<typename _Variant = base32::standard>
+    inline std::string  frombase32_s                ( const std::string&        base32          ) { return frombase32_s<_Variant>( base32.c_str(), base32.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::string  frombase32_s                ( const std::vector<char>&  base32          ) { return frombase32_s<_Variant>( base32.data(),  base32.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::string  frombase32_s                ( const small::buffer&      base32          ) { return frombase32_s<_Variant>( base32.data(),  base32.size() ); }
+
+    // frombase32_v
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> frombase32_v           ( const char* base32, const size_t& base32_length ) { std::vector<char> decoded; frombase32<_Variant>( base32, base32_length, &decoded ); return decoded; }
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> frombase32_v           ( const std::string&        base32          ) { return frombase32_v<_Variant>( base32.c_str(), base32.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> frombase32_v           ( const std::vector<char>&  base32          ) { return frombase32_v<_Variant>( base32.data(),  base32.size() ); }
+    template<typename _Variant = base32::standard>
+    inline std::vector<char> frombase32_v           ( const small::buffer&      base32          ) { return frombase32_v<_Variant>( base32.data(),  base32.size() ); }
+
+    // frombase32_b
+    template<typename _Variant = base32::standard>
+    inline small::buffer frombase32_b               ( const char* base32, const size_t& base32_length ) { small::buffer decoded; frombase32<_Variant>( base32, base32_length, &decoded ); return decoded; }
+    template<typename _Variant = base32::standard>
+    inline small::buffer frombase32_b               ( const std::string&        base32          ) { return frombase32_b<_Variant>( base32.c_str(), base32.size() ); }
+    template<typename _Variant = base32::standard>
+    inline small::buffer frombase32_b               ( const std::vector<char>&  base32          ) { return frombase32_b<_Variant>( base32.data(),  base32.size() ); }
+    template<typename _Variant = base32::standard>
+    inline small::buffer frombase32_b               ( const small::buffer&      base32          ) { return frombase32_b<_Variant>( base32.data(),  base32.size() ); }
+}
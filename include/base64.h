@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 #include "impl/base64_impl.h"
 
 #include "buffer.h"
@@ -11,46 +13,200 @@
 // std::string decoded = small::frombase64_s( b64 );
 // std::vector<char> vd64 = small::frombase64_v( b64 );
 //
+// small::buffer body( "{\"data\":\"" );
+// small::tobase64_append( data, data_length, body );                  // encoded at the end, no extra copy
+// size_t n = small::tobase64_into( data, data_length, out, out_capacity );
+//
+// std::string token = small::tobase64_s<small::base64::url_nopad>( data );
+// std::string mail  = small::tobase64_s<small::base64::mime>( attachment );
+//
+// size_t error_position = 0;
+// bool ok = small::frombase64( b64, &decoded, small::base64::EnumBase64Mode::kBase64_Strict, &error_position );
+//
+// small::frombase64_inplace( body );                                  // decoded in the same memory, body is shrunk
+//
 namespace small
 {
+    //
+    // encode in existing memory (no zero fill, no extra copy)
+    //
+
+    // encode into caller memory, returns chars written (0 if capacity is not enough)
+    template<typename _Variant = base64::standard>
+    inline size_t       tobase64_into               ( const char* src, const size_t& src_length, char* base64, const size_t& capacity )
+    {
+        size_t base64_size = base64::get_base64_size<_Variant>( src_length );
+        if ( base64 == nullptr || base64_size > capacity )
+            return 0;
+        base64::tobase64<_Variant>( base64, src, src_length );
+        return base64_size;
+    }
+
+    // encode at the end of buffer, returns chars added (0 if it could not be allocated)
+    template<typename _Variant = base64::standard>
+    inline size_t       tobase64_append             ( const char* src, const size_t& src_length, base_buffer& base64 )
+    {
+        size_t base64_size = base64::get_base64_size<_Variant>( src_length );
+        if ( base64_size == 0 )
+            return 0;
+        char* room = base64.prepare( base64_size );
+        if ( room == nullptr )
+            return 0;
+        base64::tobase64<_Variant>( room, src, src_length );
+        base64.commit( base64_size );
+        return base64_size;
+    }
+
+    // encode at the end of string, returns chars added
+    template<typename _Variant = base64::standard>
+    inline size_t       tobase64_append             ( const char* src, const size_t& src_length, std::string& base64 )
+    {
+        size_t base64_size = base64::get_base64_size<_Variant>( src_length );
+        if ( base64_size == 0 )
+            return 0;
+        size_t from = base64.size();
+#if defined(__cpp_lib_string_resize_and_overwrite)
+        base64.resize_and_overwrite( from + base64_size, [&]( char* p, size_t /*n*/ ) { base64::tobase64<_Variant>( p + from, src, src_length ); return from + base64_size; } );
+#else
+        base64.resize( from + base64_size );
+        base64::tobase64<_Variant>( base64.data() + from, src, src_length );
+#endif
+        return base64_size;
+    }
+
+    // encode at the end
+    template<typename _Variant = base64::standard, typename T>
+    inline size_t       tobase64_append             ( const std::string& src, T& base64 ) { return tobase64_append<_Variant>( src.c_str(), src.size(), base64 ); }
+
+
+
+
     //
     // implementations for common data
     //
     
-    // tobase64
-    template<typename T>
+    // tobase64 (variant base64::standard, url, url_nopad, mime, ...)
+    template<typename _Variant = base64::standard, typename T>
     inline void         tobase64                    ( const char* src, const size_t& src_length, T* base64 )
     {
         if ( base64 == nullptr )
             return;
 
-        size_t base64_size = base64::get_base64_size( src_length );
-        base64->resize( base64_size );
-        base64::tobase64( (char *)base64->data(), src, src_length );
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> || std::is_same_v<std::string, T> )
+        {
+            // write directly at the end of the emptied buffer
+            base64->clear();
+            tobase64_append<_Variant>( src, src_length, *base64 );
+        }
+        else
+        {
+            base64->resize( base64::get_base64_size<_Variant>( src_length ) );
+            base64::tobase64<_Variant>( (char *)base64->data(), src, src_length );
+        }
     }
     
     // to base64
-    template<typename T>
-    inline void         tobase64                    ( const std::string& src, T* base64     ) { return tobase64( src.c_str(), src.size(), base64 ); }
+    template<typename _Variant = base64::standard, typename T>
+    inline void         tobase64                    ( const std::string& src, T* base64     ) { return tobase64<_Variant>( src.c_str(), src.size(), base64 ); }
     
     
     // frombase64
-    template<typename T>
+    template<typename _Variant = base64::standard, typename T>
     inline void         frombase64                  ( const char* base64, const size_t& base64_length, T* decoded )
     {
         if ( decoded == nullptr )
             return;
 
         size_t decoded_size = base64::get_decodedbase64_size( base64_length );
-        
-        decoded->resize( decoded_size );
-        size_t decoded_length = base64::frombase64( (char*)decoded->data(), base64, base64_length );
-        decoded->resize( decoded_length );
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+        {
+            // decode directly in the room of the buffer and commit only the decoded length
+            decoded->clear();
+            char* room = decoded->prepare( decoded_size );
+            if ( room == nullptr )
+                return;
+            decoded->commit( base64::frombase64<_Variant>( room, base64, base64_length ) );
+        }
+        else
+        {
+            decoded->resize( decoded_size );
+            size_t decoded_length = base64::frombase64<_Variant>( (char*)decoded->data(), base64, base64_length );
+            decoded->resize( decoded_length );
+        }
     }
     
     // frombase64
-    template<typename T>
-    inline void         frombase64                  ( const std::string& base64, T* decoded ) { frombase64( base64.c_str(), base64.size(), decoded ); }
+    template<typename _Variant = base64::standard, typename T>
+    inline void         frombase64                  ( const std::string& base64, T* decoded ) { frombase64<_Variant>( base64.c_str(), base64.size(), decoded ); }
+
+
+    // frombase64 with validation (returns false on error, decoded contains what was decoded before the error)
+    template<typename _Variant = base64::standard, typename T>
+    inline bool         frombase64                  ( const char* base64, const size_t& base64_length, T* decoded, base64::EnumBase64Mode mode, size_t* error_position = nullptr )
+    {
+        size_t error = base64::npos;
+        if ( decoded != nullptr )
+        {
+            size_t decoded_size = base64::get_decodedbase64_size( base64_length );
+            if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+            {
+                decoded->clear();
+                char* room = decoded->prepare( decoded_size );
+                if ( room == nullptr )
+                    return false;
+                decoded->commit( base64::frombase64<_Variant>( room, base64, base64_length, mode, &error ) );
+            }
+            else
+            {
+                decoded->resize( decoded_size );
+                size_t decoded_length = base64::frombase64<_Variant>( (char*)decoded->data(), base64, base64_length, mode, &error );
+                decoded->resize( decoded_length );
+            }
+        }
+
+        if ( error_position )
+            *error_position = error;
+        return error == base64::npos;
+    }
+
+    // frombase64 with validation
+    template<typename _Variant = base64::standard, typename T>
+    inline bool         frombase64                  ( const std::string& base64, T* decoded, base64::EnumBase64Mode mode, size_t* error_position = nullptr ) { return frombase64<_Variant>( base64.c_str(), base64.size(), decoded, mode, error_position ); }
+
+
+    // frombase64 in the same memory, returns the decoded length (the decoded data starts at base64)
+    template<typename _Variant = base64::standard>
+    inline size_t       frombase64_inplace          ( char* base64, const size_t& base64_length,
+                                                      base64::EnumBase64Mode mode = base64::EnumBase64Mode::kBase64_SkipInvalid, size_t* error_position = nullptr )
+    {
+        if ( base64 == nullptr )
+            return 0;
+        size_t error = base64::npos;
+        size_t decoded_length = base64::frombase64<_Variant>( base64, base64, base64_length, mode, &error );
+        if ( error_position )
+            *error_position = error;
+        return decoded_length;
+    }
+
+    // frombase64 in the same buffer, shrinks it to the decoded length (returns false on error, see frombase64 with validation)
+    // false without decoding when the memory cannot be written (read only mapped_buffer)
+    template<typename _Variant = base64::standard>
+    inline bool         frombase64_inplace          ( base_buffer& base64,
+                                                      base64::EnumBase64Mode mode = base64::EnumBase64Mode::kBase64_SkipInvalid, size_t* error_position = nullptr )
+    {
+        if ( base64.size() > 0 && base64.prepare( 0 ) == nullptr )
+        {
+            if ( error_position )
+                *error_position = 0;
+            return false;
+        }
+
+        size_t error = base64::npos;
+        base64.resize( base64::frombase64<_Variant>( base64.data(), base64.data(), base64.size(), mode, &error ) );
+        if ( error_position )
+            *error_position = error;
+        return error == base64::npos;
+    }
 
 
 
@@ -58,44 +214,68 @@ namespace small
 
     //////////////////////////////////////////////////////////////////////////
     // as string
-    inline std::string  tobase64_s                  ( const char* src, const size_t& src_length ) { std::string base64; tobase64( src, src_length, &base64 ); return base64; }
-    inline std::string  tobase64_s                  ( const std::string&       src           ) { return tobase64_s( src.c_str(), src.size() ); }
-    inline std::string  tobase64_s                  ( const std::vector<char>& src           ) { return tobase64_s( src.data(),  src.size() ); }
-    inline std::string  tobase64_s                  ( const small::buffer&     src           ) { return tobase64_s( src.data(),  src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::string  tobase64_s                  ( const char* src, const size_t& src_length ) { std::string base64; tobase64<_Variant>( src, src_length, &base64 ); return base64; }
+    template<typename _Variant = base64::standard>
+    inline std::string  tobase64_s                  ( const std::string&       src           ) { return tobase64_s<_Variant>( src.c_str(), src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::string  tobase64_s                  ( const std::vector<char>& src           ) { return tobase64_s<_Variant>( src.data(),  src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::string  tobase64_s                  ( const small::buffer&     src           ) { return tobase64_s<_Variant>( src.data(),  src.size() ); }
 
     // as buffer vector<char>
-    inline std::vector<char> tobase64_v             ( const char* src, const size_t& src_length ) { std::vector<char> base64; tobase64( src, src_length, &base64 ); return base64; }
-    inline std::vector<char> tobase64_v             ( const std::string&       src           ) { return tobase64_v( src.c_str(), src.size() ); }
-    inline std::vector<char> tobase64_v             ( const std::vector<char>& src           ) { return tobase64_v( src.data(),  src.size() ); }
-    inline std::vector<char> tobase64_v             ( const small::buffer&     src           ) { return tobase64_v( src.data(),  src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> tobase64_v             ( const char* src, const size_t& src_length ) { std::vector<char> base64; tobase64<_Variant>( src, src_length, &base64 ); return base64; }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> tobase64_v             ( const std::string&       src           ) { return tobase64_v<_Variant>( src.c_str(), src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> tobase64_v             ( const std::vector<char>& src           ) { return tobase64_v<_Variant>( src.data(),  src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> tobase64_v             ( const small::buffer&     src           ) { return tobase64_v<_Variant>( src.data(),  src.size() ); }
 
     // as buffer
-    inline small::buffer tobase64_b                 ( const char* src, const size_t& src_length ) { small::buffer base64; tobase64( src, src_length, &base64 ); return base64; }
-    inline small::buffer tobase64_b                 ( const std::string&       src           ) { return tobase64_b( src.c_str(), src.size() ); }
-    inline small::buffer tobase64_b                 ( const std::vector<char>& src           ) { return tobase64_b( src.data(),  src.size() ); }
-    inline small::buffer tobase64_b                 ( const small::buffer&     src           ) { return tobase64_b( src.data(),  src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline small::buffer tobase64_b                 ( const char* src, const size_t& src_length ) { small::buffer base64; tobase64<_Variant>( src, src_length, &base64 ); return base64; }
+    template<typename _Variant = base64::standard>
+    inline small::buffer tobase64_b                 ( const std::string&       src           ) { return tobase64_b<_Variant>( src.c_str(), src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline small::buffer tobase64_b                 ( const std::vector<char>& src           ) { return tobase64_b<_Variant>( src.data(),  src.size() ); }
+    template<typename _Variant = base64::standard>
+    inline small::buffer tobase64_b                 ( const small::buffer&     src           ) { return tobase64_b<_Variant>( src.data(),  src.size() ); }
 
 
 
 
     // from base64_s
-    inline std::string  frombase64_s                ( const char* base64, const size_t& base64_length ) { std::string decoded; frombase64( base64, base64_length, &decoded ); return decoded; }
-    inline std::string  frombase64_s                ( const std::string&        base64       ) { return frombase64_s( base64.c_str(), base64.size() ); }
-    inline std::string  frombase64_s                ( const std::vector<char>&  base64       ) { return frombase64_s( base64.data(),  base64.size() ); }
-    inline std::string  frombase64_s                ( const small::buffer&      base64       ) { return frombase64_s( base64.data(),  base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::string  frombase64_s                ( const char* base64, const size_t& base64_length ) { std::string decoded; frombase64<_Variant>( base64, base64_length, &decoded ); return decoded; }
+    template<typename _Variant = base64::standard>
+    inline std::string  frombase64_s                ( const std::string&        base64       ) { return frombase64_s<_Variant>( base64.c_str(), base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::string  frombase64_s                ( const std::vector<char>&  base64       ) { return frombase64_s<_Variant>( base64.data(),  base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::string  frombase64_s                ( const small::buffer&      base64       ) { return frombase64_s<_Variant>( base64.data(),  base64.size() ); }
 
 
     // frombase64_v
-    inline std::vector<char> frombase64_v           ( const char* base64, const size_t& base64_length ) { std::vector<char> decoded; frombase64( base64, base64_length, &decoded ); return decoded; }
-    inline std::vector<char> frombase64_v           ( const std::string&        base64       ) { return frombase64_v( base64.c_str(), base64.size() ); }
-    inline std::vector<char> frombase64_v           ( const std::vector<char>&  base64       ) { return frombase64_v( base64.data(),  base64.size() ); }
-    inline std::vector<char> frombase64_v           ( const small::buffer&      base64       ) { return frombase64_v( base64.data(),  base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> frombase64_v           ( const char* base64, const size_t& base64_length ) { std::vector<char> decoded; frombase64<_Variant>( base64, base64_length, &decoded ); return decoded; }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> frombase64_v           ( const std::string&        base64       ) { return frombase64_v<_Variant>( base64.c_str(), base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> frombase64_v           ( const std::vector<char>&  base64       ) { return frombase64_v<_Variant>( base64.data(),  base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline std::vector<char> frombase64_v           ( const small::buffer&      base64       ) { return frombase64_v<_Variant>( base64.data(),  base64.size() ); }
 
     // frombase64_b
-    inline small::buffer frombase64_b               ( const char* base64, const size_t& base64_length ) { small::buffer decoded; frombase64( base64, base64_length, &decoded ); return decoded; }
-    inline small::buffer frombase64_b               ( const std::string&        base64       ) { return frombase64_b( base64.c_str(), base64.size() ); }
-    inline small::buffer frombase64_b               ( const std::vector<char>&  base64       ) { return frombase64_b( base64.data(),  base64.size() ); }
-    inline small::buffer frombase64_b               ( const small::buffer&      base64       ) { return frombase64_b( base64.data(),  base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline small::buffer frombase64_b               ( const char* base64, const size_t& base64_length ) { small::buffer decoded; frombase64<_Variant>( base64, base64_length, &decoded ); return decoded; }
+    template<typename _Variant = base64::standard>
+    inline small::buffer frombase64_b               ( const std::string&        base64       ) { return frombase64_b<_Variant>( base64.c_str(), base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline small::buffer frombase64_b               ( const std::vector<char>&  base64       ) { return frombase64_b<_Variant>( base64.data(),  base64.size() ); }
+    template<typename _Variant = base64::standard>
+    inline small::buffer frombase64_b               ( const small::buffer&      base64       ) { return frombase64_b<_Variant>( base64.data(),  base64.size() ); }
 
     
 }
\ No newline at end of file
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#include "impl/base64_impl.h"
+
+#include "buffer.h"
+#include "event.h"
+#include "worker_thread.h"
+
+//
+// base64 for big data split in chunks (whole groups) that run in parallel
+// and write directly in their own range of the output
+//
+// small::buffer b64;
+// small::tobase64_parallel( data, data_length, &b64 );               // uses a shared worker_thread pool
+// ...
+// small::buffer decoded;
+// bool ok = small::frombase64_parallel( b64.data(), b64.size(), &decoded );
+//
+// // or with another executor (any callable that runs a std::function<void()>)
+// auto executor = [&]( std::function<void()> task ) { my_pool.submit( std::move( task ) ); };
+// small::tobase64_parallel( executor, data, data_length, &b64, 8/*tasks*/ );
+//
+namespace small
+{
+    namespace base64
+    {
+        // inputs smaller than this for each task are not split
+        const size_t parallel_min_chunk_size = 1024 * 1024;
+
+
+        // threads of the shared workers
+        inline size_t   get_parallel_threads_count  ()
+        {
+            static size_t count = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+            return count;
+        }
+
+        // shared workers for the parallel functions (do not call the parallel functions from these workers)
+        inline small::worker_thread<std::function<void()>>& get_parallel_workers()
+        {
+            static small::worker_thread<std::function<void()>> workers( (int)get_parallel_threads_count(), []( auto& /*w*/, auto& task ) { task(); } );
+            return workers;
+        }
+
+        // tasks to use for length bytes
+        inline size_t   get_parallel_tasks_count    ( size_t length, size_t tasks_count )
+        {
+            size_t max_tasks = std::max<size_t>( 1, length / parallel_min_chunk_size );
+            return std::max<size_t>( 1, std::min( tasks_count, max_tasks ) );
+        }
+
+
+        // run function( index ) for each index in [0, tasks_count), index 0 runs in the calling thread, waits for all
+        template<typename _Executor, typename _Callable>
+        inline void     run_parallel                ( _Executor& executor, size_t tasks_count, _Callable function )
+        {
+            if ( tasks_count <= 1 )
+            {
+                function( 0 );
+                return;
+            }
+
+            // shared with the tasks (the last one can still signal after the wait is over)
+            struct sync_state
+            {
+                small::event            done;
+                std::atomic<size_t>     remaining{ 0 };
+            };
+            auto sync = std::make_shared<sync_state>();
+            sync->remaining.store( tasks_count - 1 );
+
+            for ( size_t i = 1; i < tasks_count; ++i )
+            {
+                executor( std::function<void()>( [sync, &function, i]()
+                {
+                    function( i );
+                    if ( sync->remaining.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+                        sync->done.set_event();
+                } ) );
+            }
+
+            function( 0 );
+            sync->done.wait( [&]() { return sync->remaining.load( std::memory_order_acquire ) == 0; } );
+        }
+    }
+
+
+
+    //
+    // encode
+    //
+
+    // tobase64 in parallel using executor
+    template<typename _Executor, typename T>
+    inline void         tobase64_parallel           ( _Executor&& executor, const char* src, const size_t& src_length, T* base64, size_t tasks_count )
+    {
+        if ( base64 == nullptr )
+            return;
+
+        size_t base64_size = base64::get_base64_size( src_length );
+        char* out = nullptr;
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+        {
+            base64->clear();
+            out = base64->prepare( base64_size );
+            if ( out == nullptr )
+                return;
+        }
+        else
+        {
+            base64->resize( base64_size );
+            out = (char*)base64->data();
+        }
+
+        // chunks of whole groups
+        tasks_count = base64::get_parallel_tasks_count( src_length, tasks_count );
+        size_t chunk = (src_length + tasks_count - 1) / tasks_count;
+        chunk = (chunk + 2) / 3 * 3;
+        tasks_count = chunk > 0 ? (src_length + chunk - 1) / chunk : 1;
+
+        base64::run_parallel( executor, tasks_count, [&]( size_t index )
+        {
+            size_t from = index * chunk;
+            size_t length = std::min( chunk, src_length - from );
+            base64::tobase64( out + from / 3 * 4, src + from, length );
+        } );
+
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+            base64->commit( base64_size );
+    }
+
+    // tobase64 in parallel using the shared workers
+    template<typename T>
+    inline void         tobase64_parallel           ( const char* src, const size_t& src_length, T* base64 )
+    {
+        auto& workers = base64::get_parallel_workers();
+        tobase64_parallel( [&]( std::function<void()> task ) { workers.push_back( std::move( task ) ); }, src, src_length, base64, base64::get_parallel_threads_count() );
+    }
+
+
+
+    //
+    // decode
+    //
+
+    // frombase64 in parallel using executor (returns false on error, see frombase64 with validation)
+    // chunks are decoded in parallel only when they contain nothing but whole groups (no whitespace
+    // or invalid chars), otherwise everything is decoded again in the calling thread
+    template<typename _Executor, typename T>
+    inline bool         frombase64_parallel         ( _Executor&& executor, const char* base64, const size_t& base64_length, T* decoded, size_t tasks_count,
+                                                      base64::EnumBase64Mode mode = base64::EnumBase64Mode::kBase64_SkipInvalid, size_t* error_position = nullptr )
+    {
+        if ( decoded == nullptr )
+            return false;
+
+        size_t decoded_size = base64::get_decodedbase64_size( base64_length );
+        char* out = nullptr;
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+        {
+            decoded->clear();
+            out = decoded->prepare( decoded_size );
+            if ( out == nullptr )
+                return false;
+        }
+        else
+        {
+            decoded->resize( decoded_size );
+            out = (char*)decoded->data();
+        }
+
+        // chunks of whole groups
+        tasks_count = base64::get_parallel_tasks_count( base64_length, tasks_count );
+        size_t chunk = (base64_length + tasks_count - 1) / tasks_count;
+        chunk = (chunk + 3) / 4 * 4;
+        tasks_count = chunk > 0 ? (base64_length + chunk - 1) / chunk : 1;
+
+        std::atomic<bool>   clean{ true };
+        size_t              last_length = 0;
+        size_t              error = base64::npos;
+        if ( tasks_count > 1 )
+        {
+            base64::run_parallel( executor, tasks_count, [&]( size_t index )
+            {
+                size_t from = index * chunk;
+                size_t length = std::min( chunk, base64_length - from );
+                size_t chunk_error = base64::npos;
+                size_t n = base64::frombase64( out + from / 4 * 3, base64 + from, length, base64::EnumBase64Mode::kBase64_Strict, &chunk_error );
+                if ( index + 1 < tasks_count )
+                {
+                    // all chunks but the last one must be made only of whole groups
+                    if ( chunk_error != base64::npos || n != length / 4 * 3 )
+                        clean.store( false, std::memory_order_relaxed );
+                }
+                else
+                {
+                    if ( chunk_error != base64::npos )
+                        clean.store( false, std::memory_order_relaxed );
+                    last_length = from / 4 * 3 + n;
+                }
+            } );
+        }
+
+        size_t decoded_length = last_length;
+        if ( tasks_count <= 1 || !clean.load() )
+            decoded_length = base64::frombase64( out, base64, base64_length, mode, &error );
+
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+            decoded->commit( decoded_length );
+        else
+            decoded->resize( decoded_length );
+
+        if ( error_position )
+            *error_position = error;
+        return error == base64::npos;
+    }
+
+    // frombase64 in parallel using the shared workers
+    template<typename T>
+    inline bool         frombase64_parallel         ( const char* base64, const size_t& base64_length, T* decoded,
+                                                      base64::EnumBase64Mode mode = base64::EnumBase64Mode::kBase64_SkipInvalid, size_t* error_position = nullptr )
+    {
+        auto& workers = base64::get_parallel_workers();
+        return frombase64_parallel( [&]( std::function<void()> task ) { workers.push_back( std::move( task ) ); }, base64, base64_length, decoded,
+                                    base64::get_parallel_threads_count(), mode, error_position );
+    }
+}
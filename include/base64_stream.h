@@ -0,0 +1,188 @@
+#pragma once
+
+#include "impl/base64_impl.h"
+
+#include "buffer.h"
+
+//
+// streaming base64 (input given in chunks of any size, constant memory)
+//
+// small::base64_encoder encoder;
+// small::buffer b64;
+// while ( ... )
+//     encoder.update( chunk, chunk_length, b64 );  // appends whole groups
+// encoder.finish( b64 );                           // appends the rest with padding
+//
+// small::base64_decoder decoder( small::base64::EnumBase64Mode::kBase64_Lenient );
+// small::buffer decoded;
+// while ( ... )
+//     if ( !decoder.update( chunk, chunk_length, decoded ) ) { ... decoder.get_error_position() ... }
+// bool ok = decoder.finish();
+//
+// or with caller buffers
+// char out[ small::base64_encoder::get_max_update_size( sizeof( in ) ) ];
+// size_t n = encoder.update( in, sizeof( in ), out );
+//
+namespace small
+{
+    // base64 encoder in chunks
+    class base64_encoder
+    {
+    public:
+        base64_encoder                              () = default;
+
+        // reset for a new stream
+        inline void     reset                       () { pending_count_ = 0; }
+
+        // bytes kept from the previous updates (0..2)
+        inline size_t   get_pending_count           () const { return pending_count_; }
+
+
+        // max chars written by update for length bytes
+        static inline size_t get_max_update_size    ( size_t length ) { return (length + 2) / 3 * 4; }
+        // max chars written by finish
+        static inline size_t get_max_finish_size    () { return 4; }
+
+
+        // encode a chunk, writes only whole groups of 4 chars (returns chars written)
+        inline size_t   update                      ( const char* src, size_t src_length, char* base64 )
+        {
+            char* out = base64;
+
+            // complete the pending group
+            if ( pending_count_ > 0 )
+            {
+                while ( pending_count_ < 3 && src_length > 0 )
+                {
+                    pending_[pending_count_++] = *src++;
+                    --src_length;
+                }
+                if ( pending_count_ < 3 )
+                    return 0;
+
+                base64::tobase64( out, pending_, 3 );
+                out += 4;
+                pending_count_ = 0;
+            }
+
+            // whole groups
+            size_t whole = src_length - src_length % 3;
+            base64::tobase64( out, src, whole );
+            out += whole / 3 * 4;
+
+            // keep the rest
+            for ( size_t i = whole; i < src_length; ++i )
+                pending_[pending_count_++] = src[i];
+
+            return (size_t)(out - base64);
+        }
+
+        // encode a chunk and append to buffer
+        inline bool     update                      ( const char* src, size_t src_length, base_buffer& base64 )
+        {
+            if ( src_length == 0 )
+                return true;
+            char* room = base64.prepare( get_max_update_size( src_length + pending_count_ ) );
+            if ( room == nullptr )
+                return false;
+            base64.commit( update( src, src_length, room ) );
+            return true;
+        }
+
+
+        // write the pending bytes with padding and reset (returns chars written, 0 or 4)
+        inline size_t   finish                      ( char* base64 )
+        {
+            size_t n = 0;
+            if ( pending_count_ > 0 )
+            {
+                base64::tobase64( base64, pending_, pending_count_ );
+                n = 4;
+            }
+            reset();
+            return n;
+        }
+
+        // write the pending bytes with padding at the end of buffer and reset
+        inline bool     finish                      ( base_buffer& base64 )
+        {
+            char* room = base64.prepare( get_max_finish_size() );
+            if ( room == nullptr )
+                return false;
+            base64.commit( finish( room ) );
+            return true;
+        }
+
+    private:
+        char            pending_[3]     = { 0, 0, 0 };
+        size_t          pending_count_  = 0;
+    };
+
+
+
+
+    // base64 decoder in chunks
+    class base64_decoder
+    {
+    public:
+        base64_decoder                              ( base64::EnumBase64Mode mode = base64::EnumBase64Mode::kBase64_SkipInvalid ) : mode_( mode ) {}
+
+        // reset for a new stream
+        inline void     reset                       () { state_ = base64::decode_state(); consumed_ = 0; error_position_ = base64::npos; }
+
+        // mode
+        inline base64::EnumBase64Mode get_mode      () const { return mode_; }
+
+        // error (position is from the start of the stream)
+        inline bool     is_error                    () const { return error_position_ != base64::npos; }
+        inline size_t   get_error_position          () const { return error_position_; }
+
+
+        // max bytes written by update for length chars (decoded bytes are written as soon as they are complete)
+        static inline size_t get_max_update_size    ( size_t length ) { return length / 4 * 3 + 3; }
+
+
+        // decode a chunk (returns bytes written, after an error nothing more is decoded)
+        inline size_t   update                      ( const char* base64, size_t base64_length, char* decoded )
+        {
+            if ( is_error() )
+                return 0;
+
+            size_t error = base64::npos;
+            size_t n = base64::frombase64_update( state_, decoded, base64, base64_length, mode_, &error );
+            if ( error != base64::npos )
+                error_position_ = consumed_ + error;
+            consumed_ += base64_length;
+            return n;
+        }
+
+        // decode a chunk and append to buffer (returns false on error)
+        inline bool     update                      ( const char* base64, size_t base64_length, base_buffer& decoded )
+        {
+            if ( is_error() )
+                return false;
+
+            char* room = decoded.prepare( get_max_update_size( base64_length ) );
+            if ( room == nullptr )
+                return false;
+            decoded.commit( update( base64, base64_length, room ) );
+            return !is_error();
+        }
+
+
+        // end of stream, returns false if there was an error or the data ended in the middle
+        // of a group or of the padding (in strict or lenient mode)
+        inline bool     finish                      ()
+        {
+            if ( !is_error() && !base64::frombase64_final( state_, mode_ ) )
+                error_position_ = consumed_;
+            return !is_error();
+        }
+
+    private:
+        base64::EnumBase64Mode  mode_;
+        base64::decode_state    state_;
+        size_t                  consumed_       = 0;
+        size_t                  error_position_ = base64::npos;
+    };
+}
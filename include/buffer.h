@@ -4,11 +4,14 @@
 #include <stddef.h>
 
 #include <type_traits>
+#include <utility>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "impl/base_buffer_impl.h"
+#include "buffer_allocator.h"
+#include "hash.h"
 
 // 
 // small::buffer b;
@@ -42,20 +45,49 @@
 // small::frombase64( s64.c_str(), (int)s64.size(), &b );
 // b = small::frombase64_b( s64 );
 //
+// small::small_buffer<64> sb = "header"; // no heap allocation until it exceeds 63 chars
+//
+// small::arena_allocator arena;
+// small::buffer ba( &arena ); // memory is carved from arena and released with arena.release()
+//
+// std::unordered_map<small::buffer, int> m;                                            // uses std::hash<small::buffer>
+// small::hashed_buffer k = "key"; unsigned long long h = k.hash();                     // cached until k changes
+// std::unordered_map<small::buffer, int, small::buffer_hash, small::buffer_equal> m2;  // m2.find( std::string_view{...} ) with c++20
+//
 namespace small
 {
     const size_t default_buffer_chunk_size = 4096;
 
+    // how the allocated size grows when more room is needed
+    enum class EnumBufferGrowth
+    {
+        kGrowth_Chunk,          // round up to the next chunk_size (a realloc every chunk_size when appending)
+        kGrowth_Geometric,      // grow at least 1.5x the current allocation (rounded to chunk_size)
+        kGrowth_Double,         // grow at least 2x the current allocation (rounded to chunk_size)
+        kGrowth_Huge,           // grow at least 2x, page aligned and huge page aligned for big sizes
+    };
+
+    // compile time default growth (can be changed with -DSMALL_BUFFER_DEFAULT_GROWTH=kGrowth_Double)
+#ifndef SMALL_BUFFER_DEFAULT_GROWTH
+#define SMALL_BUFFER_DEFAULT_GROWTH kGrowth_Chunk
+#endif
+    const EnumBufferGrowth default_buffer_growth = EnumBufferGrowth::SMALL_BUFFER_DEFAULT_GROWTH;
+
+    const size_t buffer_page_size       = 4096;
+    const size_t buffer_huge_page_size  = 2 * 1024 * 1024;
+
     // class for representing a buffer
     class buffer : public base_buffer
     {
     public:
         // buffer (allocates in chunks)
         buffer                                      ( size_t chunk_size = default_buffer_chunk_size ) { init( chunk_size ); }
+        // buffer with custom allocator (allocator must outlive the buffer)
+        buffer                                      ( buffer_allocator* allocator, size_t chunk_size = default_buffer_chunk_size ) : allocator_( allocator ? allocator : get_default_buffer_allocator() ) { init( chunk_size ); }
         
         // from buffer
         buffer                                      ( const buffer& o ) noexcept : buffer()             { init( o.chunk_size_ ); operator=( o ); }
-        buffer                                      ( buffer&&      o ) noexcept : buffer()             { init( o.chunk_size_ ); operator=( std::forward<buffer>( o ) ); }
+        buffer                                      ( buffer&&      o ) noexcept : buffer( o.allocator_, o.chunk_size_ ) { operator=( std::forward<buffer>( o ) ); }
         
         // from char*
         buffer                                      ( const char c              ) noexcept : buffer()   { base_buffer::operator=( c ); }
@@ -98,8 +130,33 @@ namespace small
         inline size_t   get_chunk_size              () const                { return chunk_size_; }
         inline void     set_chunk_size              ( size_t chunk_size )   { chunk_size_ = chunk_size; }
 
+        // growth policy
+        inline EnumBufferGrowth get_growth          () const                { return growth_; }
+        inline void     set_growth                  ( EnumBufferGrowth growth ) { growth_ = growth; }
+
+        // allocator
+        inline buffer_allocator* get_allocator      () const                { return allocator_; }
+        // changing the allocator frees current data
+        inline void     set_allocator               ( buffer_allocator* allocator ) 
+        { 
+            clear_buffer(); 
+            allocator_ = allocator ? allocator : get_default_buffer_allocator(); 
+        }
+
+        // allocated size (0 if nothing is allocated on heap)
+        inline size_t   get_alloc_size              () const                { return chunk_buffer_alloc_size_; }
+
+        // how many chars can be stored without reallocating
+        inline size_t   capacity                    () const
+        {
+            if ( chunk_buffer_alloc_size_ > 0 )
+                return chunk_buffer_alloc_size_ - sizeof(char)/*for '\0'*/;
+            return is_inline_buffer() && inline_buffer_size_ > 0 ? inline_buffer_size_ - sizeof(char)/*for '\0'*/ : 0;
+        }
+
         
         // clear / reserve / resize / shrink_to_fit fn are in base_buffer
+        // prepare / commit fn are in base_buffer (they call prepare_impl / commit_impl)
 
         // extra clear and free buffer
         inline void     clear_buffer                ()  
@@ -110,6 +167,7 @@ namespace small
        
 
         // extract buffer - be sure to call free after you use it
+        // (data from a custom allocator is copied to malloc memory)
         inline char*    extract                     ()  
         { 
             char* b =  nullptr; 
@@ -119,6 +177,18 @@ namespace small
                 if ( b )
                     *b = '\0';
             }
+            else if ( is_inline_buffer() || allocator_ != get_default_buffer_allocator() )
+            {
+                // inline data or custom allocator data must be copied to heap
+                b = (char*) malloc( chunk_buffer_length_ + sizeof(char) );
+                if ( b )
+                {
+                    memcpy( b, chunk_buffer_data_, chunk_buffer_length_ );
+                    b[chunk_buffer_length_] = '\0';
+                }
+                free_chunk_buffer();
+                init( chunk_size_ );
+            }
             else
             {
                 b = chunk_buffer_data_; 
@@ -147,6 +217,7 @@ namespace small
             if ( this != &o ) 
             { 
                 chunk_size_ = o.chunk_size_; 
+                growth_     = o.growth_;
                 ensure_size( o.size(), true/*shrink*/ );
                 set( 0/*from*/, o.data(), o.size() ); }
             return *this; 
@@ -156,12 +227,25 @@ namespace small
         { 
             if ( this != &o ) 
             { 
+                // inline data or data from another allocator cannot be stolen so copy it
+                if ( o.is_inline_buffer() || o.allocator_ != allocator_ )
+                {
+                    chunk_size_ = o.chunk_size_;
+                    growth_     = o.growth_;
+                    set( 0/*from*/, o.data(), o.size() );
+                    o.clear_buffer();
+                    return *this;
+                }
+
                 clear_buffer(); 
                 chunk_size_             = o.chunk_size_; 
-                chunk_buffer_data_      = o.chunk_buffer_data_;
+                growth_                 = o.growth_;
+                // nothing allocated: the empty buffer of o is not ours to keep
+                chunk_buffer_data_      = o.chunk_buffer_data_ != o.get_empty_buffer() ? o.chunk_buffer_data_ : (char*)get_empty_buffer();
                 chunk_buffer_length_    = o.chunk_buffer_length_;
                 chunk_buffer_alloc_size_= o.chunk_buffer_alloc_size_;
                 o.init( this->chunk_size_ ); 
+                setup_buffer( chunk_buffer_data_, chunk_buffer_length_ );
             } 
             return *this; 
         }
@@ -169,7 +253,18 @@ namespace small
         // swap
         inline void     swap                        ( buffer& o ) 
         { 
+            // inline data or data from different allocators cannot be exchanged by pointers so go through moves
+            if ( is_inline_buffer() || o.is_inline_buffer() || allocator_ != o.allocator_ )
+            {
+                buffer t( o.allocator_ );
+                t = std::move( o );
+                o       = std::move( *this );
+                *this   = std::move( t );
+                return;
+            }
+
             std::swap( chunk_size_,             o.chunk_size_           ); 
+            std::swap( growth_,                 o.growth_               ); 
             std::swap( chunk_buffer_length_,    o.chunk_buffer_length_  ); 
             std::swap( chunk_buffer_alloc_size_,o.chunk_buffer_alloc_size_ );
             // swap buffer has 4 cases
@@ -177,9 +272,20 @@ namespace small
             else if ( chunk_buffer_data_ == get_empty_buffer() && o.chunk_buffer_data_ == o.get_empty_buffer() ) { /*do nothing*/ }
             else if ( chunk_buffer_data_ != get_empty_buffer() && o.chunk_buffer_data_ == o.get_empty_buffer() ) { o.chunk_buffer_data_ = chunk_buffer_data_;    chunk_buffer_data_   = (char*)get_empty_buffer(); }
             else if ( chunk_buffer_data_ == get_empty_buffer() && o.chunk_buffer_data_ != o.get_empty_buffer() ) { chunk_buffer_data_   = o.chunk_buffer_data_;  o.chunk_buffer_data_ = (char*)o.get_empty_buffer(); }
+            
+            setup_buffer  ( chunk_buffer_data_,   chunk_buffer_length_   );
+            o.setup_buffer( o.chunk_buffer_data_, o.chunk_buffer_length_ );
         }
        
 
+    protected:
+        // buffer that keeps up to inline_size bytes (including '\0') in inline_data before going to heap
+        buffer                                      ( size_t chunk_size, char* inline_data, size_t inline_size ) : inline_buffer_data_( inline_data ), inline_buffer_size_( inline_size ) { init( chunk_size ); }
+
+        // check if data is kept in the inline storage
+        inline bool     is_inline_buffer            () const { return inline_buffer_data_ != nullptr && chunk_buffer_data_ == inline_buffer_data_; }
+
+
     private:
         // init
         inline void     init                        ( size_t chunk_size ) 
@@ -195,21 +301,61 @@ namespace small
         // free_chunk_buffer
         inline void     free_chunk_buffer           () 
         { 
-            chunk_buffer_length_        = 0; 
-            chunk_buffer_alloc_size_    = 0; 
             if ( chunk_buffer_data_ && (chunk_buffer_data_ != get_empty_buffer()) )  
             { 
-                free( chunk_buffer_data_ ); 
+                if ( !is_inline_buffer() )
+                    allocator_->deallocate( chunk_buffer_data_, chunk_buffer_alloc_size_ ); 
                 chunk_buffer_data_ = (char*)get_empty_buffer();
             }  
+            chunk_buffer_length_        = 0; 
+            chunk_buffer_alloc_size_    = 0; 
+        }
+
+
+        // compute the size to allocate for needed_size based on growth policy
+        inline size_t   get_new_alloc_size          ( size_t needed_size, const bool shrink ) const
+        {
+            size_t alloc_size = needed_size;
+            size_t round_size = chunk_size_ > 0 ? chunk_size_ : 1;
+            
+            // when shrinking or for the first allocation use exactly the needed size
+            bool grow = !shrink && chunk_buffer_alloc_size_ > 0 && needed_size > chunk_buffer_alloc_size_;
+            switch ( growth_ )
+            {
+            case EnumBufferGrowth::kGrowth_Chunk:
+                break;
+            case EnumBufferGrowth::kGrowth_Geometric:
+                if ( grow && alloc_size < chunk_buffer_alloc_size_ + chunk_buffer_alloc_size_ / 2 )
+                    alloc_size = chunk_buffer_alloc_size_ + chunk_buffer_alloc_size_ / 2;
+                break;
+            case EnumBufferGrowth::kGrowth_Double:
+                if ( grow && alloc_size < 2 * chunk_buffer_alloc_size_ )
+                    alloc_size = 2 * chunk_buffer_alloc_size_;
+                break;
+            case EnumBufferGrowth::kGrowth_Huge:
+                if ( grow && alloc_size < 2 * chunk_buffer_alloc_size_ )
+                    alloc_size = 2 * chunk_buffer_alloc_size_;
+                round_size = alloc_size >= buffer_huge_page_size ? buffer_huge_page_size : buffer_page_size;
+                break;
+            }
+
+            return ((alloc_size + (round_size - 1)) / round_size) * round_size;
         }
 
 
         // ensure size returns new_length
         inline size_t   ensure_size                 ( size_t new_size, const bool shrink = false )
         {
+            // small sizes stay in the inline storage (if any) until they no longer fit
+            if ( chunk_buffer_alloc_size_ == 0 && inline_buffer_data_ && new_size + sizeof(char)/*for '\0'*/ <= inline_buffer_size_ )
+            {
+                chunk_buffer_data_ = inline_buffer_data_;
+                chunk_buffer_data_[new_size] = '\0';
+                return new_size;
+            }
+
             // we always append a '\0' to the end so we can use as string
-            size_t new_alloc_size = ((new_size + sizeof(char)/*for '\0'*/ + (chunk_size_ - 1)) / chunk_size_) * chunk_size_;
+            size_t new_alloc_size = get_new_alloc_size( new_size + sizeof(char)/*for '\0'*/, shrink );
             bool reallocate = false;
             if ( shrink )
             {
@@ -223,7 +369,18 @@ namespace small
             // (re)allocate
             if ( reallocate )
             {
-                chunk_buffer_data_      = (chunk_buffer_alloc_size_ == 0) ? (char*)malloc( new_alloc_size ) : (char*)realloc( chunk_buffer_data_, new_alloc_size );
+                if ( chunk_buffer_alloc_size_ == 0 )
+                {
+                    char* inline_data       = is_inline_buffer() ? chunk_buffer_data_ : nullptr;
+                    chunk_buffer_data_      = (char*)allocator_->allocate( new_alloc_size );
+                    // move from inline storage to heap
+                    if ( inline_data && chunk_buffer_data_ )
+                        memcpy( chunk_buffer_data_, inline_data, chunk_buffer_length_ < new_size ? chunk_buffer_length_ : new_size );
+                }
+                else
+                {
+                    chunk_buffer_data_      = (char*)allocator_->reallocate( chunk_buffer_data_, chunk_buffer_alloc_size_, new_alloc_size );
+                }
                 chunk_buffer_alloc_size_= new_alloc_size;
             }
             
@@ -238,6 +395,7 @@ namespace small
             return new_size;
         }
 
+    protected:
         // !! override functions
         void            clear_impl                  () override
         {
@@ -264,13 +422,169 @@ namespace small
             setup_buffer( chunk_buffer_data_, chunk_buffer_length_ );
         }
 
+        // direct write (room in the allocated chunk, no resize until commit)
+        char*           prepare_impl                ( size_t n ) override
+        {
+            if ( chunk_buffer_length_ + n > capacity() )
+            {
+                ensure_size( chunk_buffer_length_ + n );
+                setup_buffer( chunk_buffer_data_, chunk_buffer_length_ );
+                if ( chunk_buffer_length_ + n > capacity() )
+                    return nullptr;
+            }
+            return chunk_buffer_data_ + chunk_buffer_length_;
+        }
+
+        void            commit_impl                 ( size_t n ) override
+        {
+            if ( chunk_buffer_length_ + n > capacity() )
+            {
+                resize_impl( chunk_buffer_length_ + n );
+                return;
+            }
+            chunk_buffer_length_ += n;
+            chunk_buffer_data_[chunk_buffer_length_] = '\0';
+            setup_buffer( chunk_buffer_data_, chunk_buffer_length_ );
+        }
+
     private:
         // chunk size
         size_t          chunk_size_;
+        // growth policy
+        EnumBufferGrowth growth_{ default_buffer_growth };
+        // allocator
+        buffer_allocator* allocator_{ get_default_buffer_allocator() };
         // buffer use char* instead of vector<char> because it is much faster
         char *          chunk_buffer_data_;
         size_t          chunk_buffer_length_;
         size_t          chunk_buffer_alloc_size_;
+        // optional inline storage (used by small_buffer)
+        char *          inline_buffer_data_{ nullptr };
+        size_t          inline_buffer_size_{ 0 };
+    };
+
+
+
+
+    // buffer that keeps up to N-1 chars (plus the '\0') inside the object
+    // and only goes to heap (in chunks) when the data no longer fits
+    template<size_t N>
+    class small_buffer : public buffer
+    {
+        static_assert( N > 0, "small_buffer needs room for at least the '\\0'" );
+
+    public:
+        // small_buffer
+        small_buffer                                ( size_t chunk_size = default_buffer_chunk_size ) : buffer( chunk_size, inline_data_, N ) {}
+
+        // from buffer
+        small_buffer                                ( const small_buffer& o ) noexcept : small_buffer( o.get_chunk_size() ) { buffer::operator=( o ); }
+        small_buffer                                ( small_buffer&&      o ) noexcept : small_buffer( o.get_chunk_size() ) { buffer::operator=( std::forward<small_buffer>( o ) ); }
+        small_buffer                                ( const buffer&       o ) noexcept : small_buffer( o.get_chunk_size() ) { buffer::operator=( o ); }
+        small_buffer                                ( buffer&&            o ) noexcept : small_buffer( o.get_chunk_size() ) { buffer::operator=( std::forward<buffer>( o ) ); }
+
+        // from char*
+        small_buffer                                ( const char c              ) noexcept : small_buffer() { set( 0/*from*/, &c,       1           ); }
+        small_buffer                                ( const char * s            ) noexcept : small_buffer() { set( 0/*from*/, s,        strlen( s ) ); }
+        small_buffer                                ( const char * s, size_t s_length ) noexcept : small_buffer() { set( 0/*from*/, s, s_length ); }
+        small_buffer                                ( const std::string& s      ) noexcept : small_buffer() { set( 0/*from*/, s.c_str(),s.size()    ); }
+        small_buffer                                ( const std::string_view s  ) noexcept : small_buffer() { set( 0/*from*/, s.data(), s.size()    ); }
+        small_buffer                                ( const std::vector<char>& v) noexcept : small_buffer() { set( 0/*from*/, v.data(), v.size()    ); }
+
+
+        // inline capacity
+        static constexpr size_t inline_capacity     () { return N - 1; }
+
+
+        // operators
+        // =
+        inline small_buffer& operator=              ( const small_buffer& o ) noexcept { buffer::operator=( o ); return *this; }
+        inline small_buffer& operator=              ( small_buffer&&      o ) noexcept { buffer::operator=( std::forward<small_buffer>( o ) ); return *this; }
+        using buffer::operator=;
+        using base_buffer::operator=;
+
+    private:
+        // inline storage
+        char            inline_data_[N];
+    };
+
+
+
+
+    // buffer that keeps its hash (fast_hash64 of the content), for keys that are hashed many times
+    // the hash is computed on the first hash() call and reset by any change
+    // (set, append, insert, erase, resize, clear, commit, non const data() or [])
+    // !! not thread safe: hash() const writes the cache, so call it before sharing the buffer between threads
+    // !! after writing through a pointer kept from before (data() / prepare) call invalidate_hash()
+    class hashed_buffer : public buffer
+    {
+    public:
+        // hashed_buffer (same constructors as buffer)
+        using buffer::buffer;
+
+        // from buffer
+        hashed_buffer                               ( const hashed_buffer& o ) noexcept : buffer( o ) {}
+        hashed_buffer                               ( hashed_buffer&&      o ) noexcept : buffer( std::forward<buffer>( o ) ) { o.invalidate_hash(); }
+        hashed_buffer                               ( const buffer&        o ) noexcept : buffer( o ) {}
+        hashed_buffer                               ( buffer&&             o ) noexcept : buffer( std::forward<buffer>( o ) ) {}
+
+
+        // cached hash
+        inline unsigned long long hash              () const
+        {
+            if ( !hash_valid_ )
+            {
+                hash_value_ = fast_hash64( buffer::data(), size() );
+                hash_valid_ = true;
+            }
+            return hash_value_;
+        }
+        inline void     invalidate_hash             ()          { hash_valid_ = false; }
+
+
+        // data access (non const access resets the hash)
+        inline const char* get_buffer               () const    { return buffer::get_buffer(); }
+        inline char*       get_buffer               ()          { invalidate_hash(); return buffer::get_buffer(); }
+
+        inline const char* data                     () const    { return buffer::data(); }
+        inline char*       data                     ()          { invalidate_hash(); return buffer::data(); }
+
+        inline char&      operator[]                ( size_t index )        { invalidate_hash(); return buffer::operator[]( index ); }
+        inline char       operator[]                ( size_t index ) const  { return buffer::operator[]( index ); }
+
+        inline char&      at                        ( size_t index )        { invalidate_hash(); return buffer::at( index ); }
+        inline char       at                        ( size_t index ) const  { return buffer::at( index ); }
+
+        inline char&      front                     ()                      { invalidate_hash(); return buffer::front(); }
+        inline char       front                     () const                { return buffer::front(); }
+
+        inline char&      back                      ()                      { invalidate_hash(); return buffer::back(); }
+        inline char       back                      () const                { return buffer::back(); }
+
+
+        // extract / swap
+        inline char*    extract                     ()                      { invalidate_hash(); return buffer::extract(); }
+        inline void     swap                        ( hashed_buffer& o )    { invalidate_hash(); o.invalidate_hash(); buffer::swap( o ); }
+
+
+        // operators
+        // =
+        inline hashed_buffer& operator=             ( const hashed_buffer& o ) noexcept { invalidate_hash(); buffer::operator=( o ); return *this; }
+        inline hashed_buffer& operator=             ( hashed_buffer&&      o ) noexcept { invalidate_hash(); o.invalidate_hash(); buffer::operator=( std::forward<buffer>( o ) ); return *this; }
+        inline hashed_buffer& operator=             ( const buffer&        o ) noexcept { invalidate_hash(); buffer::operator=( o ); return *this; }
+        inline hashed_buffer& operator=             ( buffer&&             o ) noexcept { invalidate_hash(); buffer::operator=( std::forward<buffer>( o ) ); return *this; }
+        using base_buffer::operator=;
+
+    protected:
+        // !! override functions (set / insert / erase go through resize)
+        void            clear_impl                  () override             { invalidate_hash(); buffer::clear_impl(); }
+        void            resize_impl                 ( size_t new_size ) override { invalidate_hash(); buffer::resize_impl( new_size ); }
+        void            commit_impl                 ( size_t n ) override   { invalidate_hash(); buffer::commit_impl( n ); }
+
+    private:
+        // cached hash
+        mutable unsigned long long hash_value_{ 0 };
+        mutable bool    hash_valid_{ false };
     };
 
 
@@ -309,4 +623,52 @@ namespace small
     inline buffer       operator+                   ( const std::wstring_view s,    const buffer& b){ buffer br ( b.get_chunk_size() ); br.append( s.data(),    s.size()    ); br += b; return br; }
     inline buffer       operator+                   ( const std::vector<wchar_t>&v, const buffer& b){ buffer br ( b.get_chunk_size() ); br.append( v.data(),    v.size()    ); br += b; return br; }
 
+
+
+
+    // transparent hash / equal for maps keyed by buffer (lookup with string_view, string, char* without a temporary buffer)
+    struct buffer_hash
+    {
+        using is_transparent = void;
+        using is_avalanching = void;    // well mixed (flat_map uses it as it is)
+
+        // hashed_buffer keeps its hash (a template so strings do not convert to it)
+        template<typename _Buffer, typename std::enable_if<std::is_same<_Buffer, hashed_buffer>::value, int>::type = 0>
+        inline size_t   operator()                  ( const _Buffer& b          ) const { return (size_t)b.hash(); }
+        inline size_t   operator()                  ( const base_buffer& b      ) const { return (size_t)fast_hash64( b.data(), b.size() ); }
+        inline size_t   operator()                  ( const std::string_view s  ) const { return (size_t)fast_hash64( s.data(), s.size() ); }
+    };
+
+    struct buffer_equal
+    {
+        using is_transparent = void;
+
+        inline bool     operator()                  ( const std::string_view a, const std::string_view b ) const { return a == b; }
+    };
+
 } // namespace small
+
+
+
+
+// std::hash (fast_hash64 of the content, hashed_buffer keeps it)
+namespace std
+{
+    template<>
+    struct hash<small::buffer>
+    {
+        inline size_t   operator()                  ( const small::buffer& b ) const { return (size_t)small::fast_hash64( b.data(), b.size() ); }
+    };
+
+    template<size_t N>
+    struct hash<small::small_buffer<N>>
+    {
+        inline size_t   operator()                  ( const small::small_buffer<N>& b ) const { return (size_t)small::fast_hash64( b.data(), b.size() ); }
+    };
+
+    template<>
+    struct hash<small::hashed_buffer>
+    {
+        inline size_t   operator()                  ( const small::hashed_buffer& b ) const { return (size_t)b.hash(); }
+    };
+}
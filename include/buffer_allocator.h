@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <vector>
+
+//
+// small::arena_allocator arena;
+// {
+//     small::buffer b( &arena );
+//     b.append( "hello", 5 );
+//     ...
+// }
+// ...
+// arena.release(); // free all memory at once
+//
+namespace small
+{
+    // interface used by buffer to get its memory
+    class buffer_allocator
+    {
+    public:
+        virtual ~buffer_allocator                   () {}
+
+        virtual void*   allocate                    ( size_t size ) = 0;
+        virtual void*   reallocate                  ( void* p, size_t old_size, size_t new_size ) = 0;
+        virtual void    deallocate                  ( void* p, size_t size ) = 0;
+    };
+
+
+
+    // default allocator using malloc / realloc / free
+    class malloc_allocator : public buffer_allocator
+    {
+    public:
+        void*           allocate                    ( size_t size ) override                                { return malloc( size ); }
+        void*           reallocate                  ( void* p, size_t /*old_size*/, size_t new_size ) override { return realloc( p, new_size ); }
+        void            deallocate                  ( void* p, size_t /*size*/ ) override                   { free( p ); }
+    };
+
+    // default allocator
+    inline buffer_allocator* get_default_buffer_allocator()
+    {
+        static malloc_allocator default_allocator;
+        return &default_allocator;
+    }
+
+
+
+    // monotonic arena, memory is carved from big blocks and it is released all at once
+    // deallocate only gives back the memory if it was the last allocation
+    // !! it is not thread safe, use one arena per request / thread
+    class arena_allocator : public buffer_allocator
+    {
+    public:
+        arena_allocator                             ( size_t block_size = 64 * 1024 ) : block_size_( block_size ) {}
+        ~arena_allocator                            () override { release(); }
+
+        arena_allocator                             ( const arena_allocator& ) = delete;
+        arena_allocator&    operator=               ( const arena_allocator& ) = delete;
+
+
+        // allocate
+        void*           allocate                    ( size_t size ) override
+        {
+            size = align( size );
+            if ( current_ == nullptr || current_->used + size > current_->size )
+            {
+                if ( !add_block( size ) )
+                    return nullptr;
+            }
+
+            char* p = current_->data() + current_->used;
+            current_->used += size;
+            last_ = p;
+            return p;
+        }
+
+        // reallocate (in place if it was the last allocation and there is room)
+        void*           reallocate                  ( void* p, size_t old_size, size_t new_size ) override
+        {
+            if ( p == nullptr )
+                return allocate( new_size );
+
+            if ( p == last_ && current_ )
+            {
+                size_t offset = (char*)p - current_->data();
+                if ( offset + align( new_size ) <= current_->size )
+                {
+                    current_->used = offset + align( new_size );
+                    return p;
+                }
+            }
+
+            void* n = allocate( new_size );
+            if ( n )
+                memcpy( n, p, old_size < new_size ? old_size : new_size );
+            return n;
+        }
+
+        // deallocate (only the last allocation is reused)
+        void            deallocate                  ( void* p, size_t /*size*/ ) override
+        {
+            if ( p != nullptr && p == last_ && current_ )
+            {
+                current_->used  = (char*)p - current_->data();
+                last_           = nullptr;
+            }
+        }
+
+
+        // release all memory (all buffers using this arena must not be used anymore)
+        inline void     release                     ()
+        {
+            for ( auto* b : blocks_ )
+                free( b );
+            blocks_.clear();
+            current_        = nullptr;
+            last_           = nullptr;
+            allocated_size_ = 0;
+        }
+
+        // reset keeps the first block for reuse
+        inline void     reset                       ()
+        {
+            for ( size_t i = 1; i < blocks_.size(); ++i )
+                free( blocks_[i] );
+            if ( blocks_.size() > 1 )
+                blocks_.resize( 1 );
+
+            current_        = blocks_.empty() ? nullptr : blocks_[0];
+            last_           = nullptr;
+            allocated_size_ = current_ ? current_->size : 0;
+            if ( current_ )
+                current_->used = 0;
+        }
+
+
+        // total memory taken from heap
+        inline size_t   get_allocated_size          () const { return allocated_size_; }
+        inline size_t   get_block_size              () const { return block_size_; }
+
+
+    private:
+        // block header followed by data
+        struct block
+        {
+            size_t      size;
+            size_t      used;
+            size_t      reserved[2];        // 32 bytes header so data keeps the 16 bytes alignment of malloc
+            inline char* data               () { return (char*)(this + 1); }
+        };
+
+        // align to 16
+        static inline size_t align                  ( size_t size ) { return (size + 15) & ~(size_t)15; }
+
+        // add new block
+        inline bool     add_block                   ( size_t min_size )
+        {
+            // big allocations get room to grow in place
+            size_t size = 2 * min_size > block_size_ ? 2 * min_size : block_size_;
+            block* b = (block*)malloc( sizeof( block ) + size );
+            if ( b == nullptr )
+                return false;
+
+            b->size = size;
+            b->used = 0;
+            blocks_.push_back( b );
+            current_         = b;
+            allocated_size_ += size;
+            return true;
+        }
+
+    private:
+        // block size
+        size_t              block_size_;
+        // blocks
+        std::vector<block*> blocks_;
+        block*              current_{ nullptr };
+        // last allocation (can be reallocated in place)
+        void*               last_{ nullptr };
+        size_t              allocated_size_{ 0 };
+    };
+}
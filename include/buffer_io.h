@@ -0,0 +1,201 @@
+#pragma once
+
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "buffer.h"
+#include "segmented_buffer.h"
+
+//
+// zero copy io (posix) directly from / into buffers
+//
+// small::buffer b;
+// ssize_t r = small::read_from_fd( fd, b, 64 * 1024 ); // appends at most 64k read from fd
+// ...
+// ssize_t w = small::write_to_fd( fd, b );
+//
+// small::segmented_buffer sb;
+// small::read_from_fd( fd, sb, 1024 * 1024 );          // readv into spare room of segments
+// small::write_to_fd( fd, sb );                        // writev of all segments
+//
+// std::vector<struct iovec> iov;
+// small::to_iovec( sb, iov );
+//
+namespace small
+{
+#ifdef IOV_MAX
+    const size_t max_iovec_count = IOV_MAX;
+#else
+    const size_t max_iovec_count = 1024;
+#endif
+
+    //
+    // iovec export
+    //
+
+    // one iovec for a contiguous buffer (from position)
+    inline struct iovec to_iovec                    ( const base_buffer& b, size_t from = 0 )
+    {
+        struct iovec iov;
+        iov.iov_base = (void*)(b.data() + (from < b.size() ? from : b.size()));
+        iov.iov_len  = from < b.size() ? b.size() - from : 0;
+        return iov;
+    }
+
+    // iovecs for all segments (from position), returns the count added
+    inline size_t       to_iovec                    ( const segmented_buffer& sb, std::vector<struct iovec>& iov, size_t from = 0 )
+    {
+        size_t count = 0;
+        sb.for_each_segment( [&]( std::string_view s )
+        {
+            if ( from >= s.size() )
+            {
+                from -= s.size();
+                return;
+            }
+            struct iovec v;
+            v.iov_base  = (void*)(s.data() + from);
+            v.iov_len   = s.size() - from;
+            from        = 0;
+            iov.push_back( v );
+            ++count;
+        } );
+        return count;
+    }
+
+
+
+    //
+    // write
+    //
+
+    // write all iovecs (handles partial writes), returns bytes written or -1 if nothing could be written
+    inline ssize_t      write_to_fd                 ( int fd, struct iovec* iov, size_t iov_count )
+    {
+        ssize_t total = 0;
+        while ( iov_count > 0 )
+        {
+            ssize_t w = ::writev( fd, iov, (int)(iov_count < max_iovec_count ? iov_count : max_iovec_count) );
+            if ( w < 0 )
+            {
+                if ( errno == EINTR )
+                    continue;
+                return total > 0 ? total : -1;
+            }
+            if ( w == 0 )
+                break;
+
+            total += w;
+            // skip what was written
+            size_t written = (size_t)w;
+            while ( iov_count > 0 && written >= iov->iov_len )
+            {
+                written -= iov->iov_len;
+                ++iov;
+                --iov_count;
+            }
+            if ( iov_count > 0 )
+            {
+                iov->iov_base = (char*)iov->iov_base + written;
+                iov->iov_len -= written;
+            }
+        }
+        return total;
+    }
+
+    // write buffer (from position)
+    inline ssize_t      write_to_fd                 ( int fd, const base_buffer& b, size_t from = 0 )
+    {
+        struct iovec iov = to_iovec( b, from );
+        return write_to_fd( fd, &iov, 1 );
+    }
+
+    // write segmented buffer (from position)
+    inline ssize_t      write_to_fd                 ( int fd, const segmented_buffer& sb, size_t from = 0 )
+    {
+        std::vector<struct iovec> iov;
+        iov.reserve( sb.segments_count() );
+        to_iovec( sb, iov, from );
+        return write_to_fd( fd, iov.data(), iov.size() );
+    }
+
+
+
+    //
+    // read
+    //
+
+    // read at most max_length bytes at the end of buffer (one read call)
+    // returns bytes read, 0 on eof, -1 on error (see errno, EINVAL when max_length is 0, ENOMEM when there is no room)
+    inline ssize_t      read_from_fd                ( int fd, buffer& b, size_t max_length )
+    {
+        if ( max_length == 0 )
+        {
+            errno = EINVAL; // 0 would mean eof
+            return -1;
+        }
+
+        char* room = b.prepare( max_length );
+        if ( room == nullptr )
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+
+        ssize_t r = 0;
+        do
+        {
+            r = ::read( fd, room, max_length );
+        } while ( r < 0 && errno == EINTR );
+
+        if ( r > 0 )
+            b.commit( (size_t)r );
+        return r;
+    }
+
+    // read at most max_length bytes at the end of segmented buffer (one readv call, the same returns as above)
+    inline ssize_t      read_from_fd                ( int fd, segmented_buffer& sb, size_t max_length )
+    {
+        if ( max_length == 0 )
+        {
+            errno = EINVAL;
+            return -1;
+        }
+
+        std::vector<struct iovec> iov;
+        size_t room = 0;
+        sb.prepare( max_length, [&]( char* p, size_t n )
+        {
+            if ( room >= max_length || iov.size() >= max_iovec_count )
+                return;
+            if ( n > max_length - room )
+                n = max_length - room;
+            struct iovec v;
+            v.iov_base  = p;
+            v.iov_len   = n;
+            iov.push_back( v );
+            room += n;
+        } );
+        if ( iov.empty() )
+        {
+            sb.commit( 0 );
+            errno = ENOMEM;
+            return -1;
+        }
+
+        ssize_t r = 0;
+        do
+        {
+            r = ::readv( fd, iov.data(), (int)iov.size() );
+        } while ( r < 0 && errno == EINTR );
+
+        sb.commit( r > 0 ? (size_t)r : 0 );
+        return r;
+    }
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "buffer.h"
+#include "spinlock.h"
+
+//
+// small::buffer_pool pool;
+// ...
+// {
+//     auto b = pool.acquire(); // RAII handle, buffer keeps its previous allocation
+//     b->append( "hello", 5 );
+//     ...
+// } // buffer goes back to the pool (length is reset, allocation is kept)
+// ...
+// small::buffer b1 = pool.acquire_buffer();
+// ...
+// pool.release( std::move( b1 ) );
+// ...
+// auto hits = pool.get_hits(); auto misses = pool.get_misses();
+//
+namespace small
+{
+    // pool of buffers with per thread caches and a shared overflow list
+    class buffer_pool
+    {
+    public:
+        // RAII handle that gives back the buffer to the pool
+        class handle
+        {
+        public:
+            handle                                  () = default;
+            handle                                  ( buffer_pool* pool, buffer&& b ) : pool_( pool ), buffer_( std::forward<buffer>( b ) ) {}
+            handle                                  ( handle&& o ) noexcept : pool_( o.pool_ ), buffer_( std::forward<buffer>( o.buffer_ ) ) { o.pool_ = nullptr; }
+            ~handle                                 () { release(); }
+
+            handle                                  ( const handle& ) = delete;
+            handle&         operator=               ( const handle& ) = delete;
+            handle&         operator=               ( handle&& o ) noexcept
+            {
+                if ( this != &o )
+                {
+                    release();
+                    pool_   = o.pool_;
+                    buffer_ = std::move( o.buffer_ );
+                    o.pool_ = nullptr;
+                }
+                return *this;
+            }
+
+            // access
+            inline buffer&          operator*       ()          { return buffer_; }
+            inline const buffer&    operator*       () const    { return buffer_; }
+            inline buffer*          operator->      ()          { return &buffer_; }
+            inline const buffer*    operator->      () const    { return &buffer_; }
+            inline buffer&          get             ()          { return buffer_; }
+
+            // give back the buffer to the pool now
+            inline void     release                 ()
+            {
+                if ( pool_ )
+                {
+                    pool_->release( std::move( buffer_ ) );
+                    pool_ = nullptr;
+                }
+            }
+
+        private:
+            buffer_pool*    pool_{ nullptr };
+            buffer          buffer_;
+        };
+
+
+    public:
+        // buffer_pool (buffers with bigger allocation than max_retained_capacity are freed instead of kept)
+        // max_retained_count buffers are kept in the shared list and max_thread_cached_count in the cache of each thread
+        buffer_pool                                 ( size_t max_retained_capacity = 1024 * 1024, size_t max_retained_count = 1024, size_t max_thread_cached_count = 16, size_t chunk_size = default_buffer_chunk_size )
+                                                        : state_( std::make_shared<pool_state>() ), max_retained_capacity_( max_retained_capacity ), max_retained_count_( max_retained_count ),
+                                                        max_thread_cached_count_( max_thread_cached_count ), chunk_size_( chunk_size ) {}
+        ~buffer_pool                                () { clear(); state_->generation.store( dead_generation, std::memory_order_release ); }
+
+        buffer_pool                                 ( const buffer_pool& ) = delete;
+        buffer_pool&    operator=                   ( const buffer_pool& ) = delete;
+
+
+        // acquire as RAII handle
+        inline handle   acquire                     () { return handle( this, acquire_buffer() ); }
+
+        // acquire buffer (be sure to call release when done)
+        inline buffer   acquire_buffer              ()
+        {
+            // thread cache
+            auto* cache = get_thread_cache( false/*create*/ );
+            if ( cache && !cache->buffers.empty() )
+            {
+                buffer b( std::move( cache->buffers.back() ) );
+                cache->buffers.pop_back();
+                hits_.fetch_add( 1, std::memory_order_relaxed );
+                return b;
+            }
+
+            // shared overflow
+            {
+                std::unique_lock<small::spinlock> mlock( lock_ );
+                if ( !overflow_.empty() )
+                {
+                    buffer b( std::move( overflow_.back() ) );
+                    overflow_.pop_back();
+                    mlock.unlock();
+                    hits_.fetch_add( 1, std::memory_order_relaxed );
+                    return b;
+                }
+            }
+
+            misses_.fetch_add( 1, std::memory_order_relaxed );
+            return buffer( chunk_size_ );
+        }
+
+        // give back a buffer (length is reset, allocation is kept)
+        inline void     release                     ( buffer&& b )
+        {
+            // too big or not our kind of memory
+            if ( b.get_alloc_size() == 0 || b.get_alloc_size() > max_retained_capacity_ || b.get_allocator() != get_default_buffer_allocator() )
+            {
+                discarded_.fetch_add( 1, std::memory_order_relaxed );
+                b.clear_buffer();
+                return;
+            }
+            b.clear();
+
+            // thread cache
+            auto* cache = get_thread_cache( true/*create*/ );
+            if ( cache && cache->buffers.size() < max_thread_cached_count_ )
+            {
+                cache->buffers.emplace_back( std::forward<buffer>( b ) );
+                return;
+            }
+
+            // shared overflow
+            {
+                std::unique_lock<small::spinlock> mlock( lock_ );
+                if ( overflow_.size() < max_retained_count_ )
+                {
+                    overflow_.emplace_back( std::forward<buffer>( b ) );
+                    return;
+                }
+            }
+
+            discarded_.fetch_add( 1, std::memory_order_relaxed );
+            b.clear_buffer();
+        }
+
+
+        // free the retained buffers (shared list and the cache of the current thread)
+        // caches of other threads see the new generation and are freed on their next access to any pool
+        inline void     clear                       ()
+        {
+            state_->generation.fetch_add( 1, std::memory_order_release );
+            get_thread_cache( false/*create*/ );
+
+            std::unique_lock<small::spinlock> mlock( lock_ );
+            overflow_.clear();
+        }
+
+
+        // counters
+        inline size_t   get_hits                    () const { return hits_.load( std::memory_order_relaxed );      }
+        inline size_t   get_misses                  () const { return misses_.load( std::memory_order_relaxed );    }
+        inline size_t   get_discarded               () const { return discarded_.load( std::memory_order_relaxed ); }
+
+        // limits
+        inline size_t   get_max_retained_capacity   () const { return max_retained_capacity_; }
+        inline void     set_max_retained_capacity   ( size_t max_retained_capacity ) { max_retained_capacity_ = max_retained_capacity; }
+
+
+    private:
+        // state shared by a pool and the thread caches that refer to it (it outlives the pool)
+        // clear moves the generation, the destructor sets it to dead_generation
+        struct pool_state
+        {
+            std::atomic<unsigned long long> generation{ 0 };
+        };
+        static constexpr unsigned long long dead_generation = ~0ULL;
+
+        // per thread cache of one pool
+        struct thread_cache
+        {
+            std::shared_ptr<pool_state> state;
+            unsigned long long  generation;
+            std::vector<buffer> buffers;
+        };
+
+        // get the cache of the current thread for this pool
+        // caches of cleared pools are emptied and caches of destroyed pools are freed on the way
+        inline thread_cache* get_thread_cache       ( bool create )
+        {
+            thread_local std::vector<thread_cache> caches;
+            thread_cache* found = nullptr;
+            thread_cache* empty = nullptr;
+            for ( auto& c : caches )
+            {
+                if ( c.state )
+                {
+                    unsigned long long generation = c.state->generation.load( std::memory_order_acquire );
+                    if ( generation != c.generation )
+                    {
+                        c.buffers.clear();
+                        c.generation = generation;
+                        if ( generation == dead_generation )
+                            c.state.reset();
+                    }
+                }
+
+                if ( c.state == state_ )
+                    found = &c;
+                else if ( !c.state && empty == nullptr )
+                    empty = &c;
+            }
+            if ( found || !create )
+                return found;
+
+            // reuse the slot of a destroyed pool
+            if ( empty )
+            {
+                empty->state        = state_;
+                empty->generation   = state_->generation.load( std::memory_order_acquire );
+                return empty;
+            }
+            caches.push_back( thread_cache{ state_, state_->generation.load( std::memory_order_acquire ), {} } );
+            return &caches.back();
+        }
+
+
+    private:
+        // shared state (generation)
+        std::shared_ptr<pool_state> state_;
+        // limits
+        size_t              max_retained_capacity_;
+        size_t              max_retained_count_;        // shared list
+        size_t              max_thread_cached_count_;   // cache of each thread
+        size_t              chunk_size_;
+
+        // shared overflow
+        small::spinlock     lock_;
+        std::vector<buffer> overflow_;
+
+        // counters
+        std::atomic<size_t> hits_{ 0 };
+        std::atomic<size_t> misses_{ 0 };
+        std::atomic<size_t> discarded_{ 0 };
+    };
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <string.h>
+#include <stddef.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// small::buffer b = "key=value;other=1";
+// small::buffer_view v = b.slice( 0, 9 );   // "key=value" no copy
+//
+// small::buffer_view rest = b.view();
+// small::buffer_view token;
+// while ( rest.next_token( ';', &token ) )
+// {
+//     size_t eq = token.find( '=' );
+//     small::buffer_view key   = token.substr( 0, eq );
+//     small::buffer_view value = token.substr( eq + 1 );
+//     ...
+// }
+//
+namespace small
+{
+    // non owning view over chars (the data must outlive the view)
+    class buffer_view
+    {
+    public:
+        static constexpr size_t npos = std::string_view::npos;
+
+        // buffer_view
+        constexpr buffer_view                       () noexcept : data_( "" ), length_( 0 ) {}
+        constexpr buffer_view                       ( const char* s, size_t s_length ) noexcept : data_( s ? s : "" ), length_( s ? s_length : 0 ) {}
+        buffer_view                                 ( const char* s ) noexcept : data_( s ? s : "" ), length_( s ? strlen( s ) : 0 ) {}
+        buffer_view                                 ( const std::string& s ) noexcept : data_( s.data() ), length_( s.size() ) {}
+        constexpr buffer_view                       ( const std::string_view s ) noexcept : data_( s.data() ), length_( s.size() ) {}
+        buffer_view                                 ( const std::vector<char>& v ) noexcept : data_( v.data() ), length_( v.size() ) {}
+
+
+        // size / length / empty
+        inline size_t   size                        () const    { return length_;       }
+        inline size_t   length                      () const    { return size();        }
+        inline bool     empty                       () const    { return size() == 0;   }
+
+        // data access
+        inline const char* data                     () const    { return data_;         }
+        inline const char* begin                    () const    { return data_;         }
+        inline const char* end                      () const    { return data_ + length_; }
+
+        // conversion (copy)
+        inline std::string      c_string            () const    { return std::string( data(), size() ); }
+        inline std::vector<char>c_vector            () const    { return std::vector<char>( data(), data() + size() ); }
+        inline std::string_view c_view              () const    { return std::string_view{ data(), size() }; }
+
+
+        // [] / at / front / back
+        inline char     operator[]                  ( size_t index ) const  { return data_[ index ]; }
+        inline char     at                          ( size_t index ) const  { return data_[ index ]; }
+        inline char     front                       () const                { return data_[ 0 ]; }
+        inline char     back                        () const                { return size() > 0 ? data_[ size() - 1 ] : data_[ 0 ]; }
+
+
+        // sub views
+        inline buffer_view substr                   ( size_t from, size_t len = npos ) const
+        {
+            if ( from > size() )
+                from = size();
+            if ( len > size() - from )
+                len = size() - from;
+            return buffer_view( data() + from, len );
+        }
+        inline buffer_view slice                    ( size_t from, size_t len = npos ) const { return substr( from, len ); }
+
+        inline void     remove_prefix               ( size_t n ) { if ( n > size() ) { n = size(); } data_ += n; length_ -= n; }
+        inline void     remove_suffix               ( size_t n ) { if ( n > size() ) { n = size(); } length_ -= n; }
+
+
+        // compare
+        inline bool     is_equal                    ( const char *s, size_t s_length ) const { return size() == s_length && compare( s, s_length ) == 0; }
+        inline int      compare                     ( const char *s, size_t s_length ) const
+        {
+            int cmp = size() > 0 && s_length > 0 ? memcmp( data(), s, size() < s_length ? size() : s_length ) : 0;
+            return (cmp != 0) ? /*different*/cmp : /*equal so far*/(size() == s_length ? 0/*true equal*/ : (size() < s_length ? -1 : 1));
+        }
+
+
+        // search
+        inline size_t   find                        ( const char  c,                size_t from = 0 ) const { return c_view().find( c, from ); }
+        inline size_t   find                        ( const char* s,                size_t from = 0 ) const { return c_view().find( s, from ); }
+        inline size_t   find                        ( const char* s, size_t len,    size_t from     ) const { return c_view().find( s, from, len ); }
+        inline size_t   find                        ( const std::string_view s,     size_t from = 0 ) const { return c_view().find( s, from ); }
+
+        inline size_t   rfind                       ( const char  c,                size_t from = npos ) const { return c_view().rfind( c, from ); }
+        inline size_t   rfind                       ( const char* s,                size_t from = npos ) const { return c_view().rfind( s, from ); }
+        inline size_t   rfind                       ( const std::string_view s,     size_t from = npos ) const { return c_view().rfind( s, from ); }
+
+        inline size_t   find_first_of               ( const std::string_view s,     size_t from = 0 ) const { return c_view().find_first_of( s, from ); }
+        inline size_t   find_first_not_of           ( const std::string_view s,     size_t from = 0 ) const { return c_view().find_first_not_of( s, from ); }
+
+        inline bool     starts_with                 ( const std::string_view s ) const { return size() >= s.size() && memcmp( data(), s.data(), s.size() ) == 0; }
+        inline bool     starts_with                 ( const char c ) const             { return size() > 0 && front() == c; }
+        inline bool     ends_with                   ( const std::string_view s ) const { return size() >= s.size() && memcmp( data() + size() - s.size(), s.data(), s.size() ) == 0; }
+        inline bool     ends_with                   ( const char c ) const             { return size() > 0 && back() == c; }
+
+
+        // tokenize
+        // takes the next token until separator (the view advances after the separator)
+        // returns false when nothing is left (so an empty token after the last separator is not returned)
+        inline bool     next_token                  ( const char separator, buffer_view* token )
+        {
+            if ( token == nullptr || empty() )
+                return false;
+
+            size_t pos = find( separator );
+            if ( pos == npos )
+            {
+                *token = *this;
+                remove_prefix( size() );
+                return true;
+            }
+            *token = substr( 0, pos );
+            remove_prefix( pos + 1 );
+            return true;
+        }
+
+        inline bool     next_token                  ( const std::string_view separator, buffer_view* token )
+        {
+            if ( token == nullptr || empty() )
+                return false;
+
+            size_t pos = separator.empty() ? npos : find( separator );
+            if ( pos == npos )
+            {
+                *token = *this;
+                remove_prefix( size() );
+                return true;
+            }
+            *token = substr( 0, pos );
+            remove_prefix( pos + separator.size() );
+            return true;
+        }
+
+        // split in tokens
+        inline std::vector<buffer_view> split       ( const char separator ) const
+        {
+            std::vector<buffer_view> tokens;
+            buffer_view rest = *this;
+            buffer_view token;
+            while ( rest.next_token( separator, &token ) )
+                tokens.push_back( token );
+            return tokens;
+        }
+
+
+        // operator
+        inline          operator std::string_view   () const    { return c_view(); }
+
+
+    private:
+        // members
+        const char*     data_;
+        size_t          length_;
+    };
+
+
+
+    // ==
+    inline bool         operator==                  ( const buffer_view& v, const buffer_view& v2     ) { return v.is_equal( v2.data(),  v2.size()  ); }
+    inline bool         operator==                  ( const buffer_view& v, const char*   s           ) { return v.is_equal( s,          strlen( s )); }
+    inline bool         operator==                  ( const buffer_view& v, const std::string&  s     ) { return v.is_equal( s.c_str(),  s.size()   ); }
+    inline bool         operator==                  ( const buffer_view& v, const std::string_view s  ) { return v.is_equal( s.data(),   s.size()   ); }
+    inline bool         operator==                  ( const char* s,            const buffer_view& v  ) { return v.is_equal( s,          strlen( s )); }
+    inline bool         operator==                  ( const std::string& s,     const buffer_view& v  ) { return v.is_equal( s.c_str(),  s.size()   ); }
+    inline bool         operator==                  ( const std::string_view s, const buffer_view& v  ) { return v.is_equal( s.data(),   s.size()   ); }
+
+    // !=
+    inline bool         operator!=                  ( const buffer_view& v, const buffer_view& v2     ) { return !v.is_equal( v2.data(), v2.size()  ); }
+    inline bool         operator!=                  ( const buffer_view& v, const char*   s           ) { return !v.is_equal( s,         strlen( s )); }
+    inline bool         operator!=                  ( const buffer_view& v, const std::string&  s     ) { return !v.is_equal( s.c_str(), s.size()   ); }
+    inline bool         operator!=                  ( const buffer_view& v, const std::string_view s  ) { return !v.is_equal( s.data(),  s.size()   ); }
+    inline bool         operator!=                  ( const char* s,            const buffer_view& v  ) { return !v.is_equal( s,         strlen( s )); }
+    inline bool         operator!=                  ( const std::string& s,     const buffer_view& v  ) { return !v.is_equal( s.c_str(), s.size()   ); }
+    inline bool         operator!=                  ( const std::string_view s, const buffer_view& v  ) { return !v.is_equal( s.data(),  s.size()   ); }
+
+    // <
+    inline bool         operator<                   ( const buffer_view& v, const buffer_view& v2     ) { return v.compare( v2.data(), v2.size()    ) < 0; }
+    inline bool         operator<                   ( const buffer_view& v, const char* s             ) { return v.compare( s,         strlen( s )  ) < 0; }
+    inline bool         operator<                   ( const buffer_view& v, const std::string& s      ) { return v.compare( s.c_str(), s.size()     ) < 0; }
+    inline bool         operator<                   ( const buffer_view& v, const std::string_view s  ) { return v.compare( s.data(),  s.size()     ) < 0; }
+    inline bool         operator<                   ( const char* s,            const buffer_view& v  ) { return v.compare( s,         strlen( s )  ) > 0; }
+    inline bool         operator<                   ( const std::string& s,     const buffer_view& v  ) { return v.compare( s.c_str(), s.size()     ) > 0; }
+    inline bool         operator<                   ( const std::string_view s, const buffer_view& v  ) { return v.compare( s.data(),  s.size()     ) > 0; }
+
+    // <=
+    inline bool         operator<=                  ( const buffer_view& v, const buffer_view& v2     ) { return v.compare( v2.data(), v2.size()    ) <= 0; }
+    inline bool         operator<=                  ( const buffer_view& v, const char* s             ) { return v.compare( s,         strlen( s )  ) <= 0; }
+    inline bool         operator<=                  ( const buffer_view& v, const std::string& s      ) { return v.compare( s.c_str(), s.size()     ) <= 0; }
+    inline bool         operator<=                  ( const buffer_view& v, const std::string_view s  ) { return v.compare( s.data(),  s.size()     ) <= 0; }
+    inline bool         operator<=                  ( const char* s,            const buffer_view& v  ) { return v.compare( s,         strlen( s )  ) >= 0; }
+    inline bool         operator<=                  ( const std::string& s,     const buffer_view& v  ) { return v.compare( s.c_str(), s.size()     ) >= 0; }
+    inline bool         operator<=                  ( const std::string_view s, const buffer_view& v  ) { return v.compare( s.data(),  s.size()     ) >= 0; }
+
+    // >
+    inline bool         operator>                   ( const buffer_view& v, const buffer_view& v2     ) { return v.compare( v2.data(), v2.size()    ) > 0; }
+    inline bool         operator>                   ( const buffer_view& v, const char* s             ) { return v.compare( s,         strlen( s )  ) > 0; }
+    inline bool         operator>                   ( const buffer_view& v, const std::string& s      ) { return v.compare( s.c_str(), s.size()     ) > 0; }
+    inline bool         operator>                   ( const buffer_view& v, const std::string_view s  ) { return v.compare( s.data(),  s.size()     ) > 0; }
+    inline bool         operator>                   ( const char* s,            const buffer_view& v  ) { return v.compare( s,         strlen( s )  ) < 0; }
+    inline bool         operator>                   ( const std::string& s,     const buffer_view& v  ) { return v.compare( s.c_str(), s.size()     ) < 0; }
+    inline bool         operator>                   ( const std::string_view s, const buffer_view& v  ) { return v.compare( s.data(),  s.size()     ) < 0; }
+
+    // >=
+    inline bool         operator>=                  ( const buffer_view& v, const buffer_view& v2     ) { return v.compare( v2.data(), v2.size()    ) >= 0; }
+    inline bool         operator>=                  ( const buffer_view& v, const char* s             ) { return v.compare( s,         strlen( s )  ) >= 0; }
+    inline bool         operator>=                  ( const buffer_view& v, const std::string& s      ) { return v.compare( s.c_str(), s.size()     ) >= 0; }
+    inline bool         operator>=                  ( const buffer_view& v, const std::string_view s  ) { return v.compare( s.data(),  s.size()     ) >= 0; }
+    inline bool         operator>=                  ( const char* s,            const buffer_view& v  ) { return v.compare( s,         strlen( s )  ) <= 0; }
+    inline bool         operator>=                  ( const std::string& s,     const buffer_view& v  ) { return v.compare( s.c_str(), s.size()     ) <= 0; }
+    inline bool         operator>=                  ( const std::string_view s, const buffer_view& v  ) { return v.compare( s.data(),  s.size()     ) <= 0; }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+
+#include "buffer.h"
+#include "hash.h"
+#include "impl/flat_table_impl.h"
+
+//
+// small::flat_map<std::string, int> m;                // keys std::string, small::buffer, small::small_buffer<N>, ...
+// m["accept"] = 1;
+// m.insert( { "host", 2 } );
+// m.try_emplace( std::string_view{ "via" }, 3 );      // the key is built only when it is missing
+//
+// auto it = m.find( std::string_view{ "host" } );     // no temporary key
+// if ( it != m.end() ) { it->second ... }
+// m.erase( "accept" );
+//
+// small::flat_map<std::string, int, small::flat_quick_hash> mq;                  // quick_hash instead of fast_hash64
+// small::flat_map<int, int, std::hash<int>, std::equal_to<int>> mi;             // other keys
+//
+namespace small
+{
+    // fast_hash64 of the key bytes (hashed_buffer keys use their cached hash), lookup with string_view, string, char*
+    using flat_hash     = buffer_hash;
+    using flat_equal    = buffer_equal;
+
+    // quick_hash of the key bytes (mixed by the table)
+    struct flat_quick_hash
+    {
+        using is_transparent = void;
+
+        inline size_t   operator()                  ( const std::string_view s  ) const { return (size_t)quick_hash( s.data(), s.size() ); }
+    };
+
+
+
+
+    // open addressing hash map (elements are moved on rehash, so pointers and iterators are valid only until the next insert)
+    template<typename _Key, typename _Value, typename _Hash = flat_hash, typename _Equal = flat_equal>
+    class flat_map : public flat::table<flat::map_policy<_Key, _Value>, _Hash, _Equal>
+    {
+        using base = flat::table<flat::map_policy<_Key, _Value>, _Hash, _Equal>;
+
+    public:
+        using key_type          = typename base::key_type;
+        using mapped_type       = _Value;
+        using value_type        = typename base::value_type;
+        using iterator          = typename base::iterator;
+        using const_iterator    = typename base::const_iterator;
+
+        template<typename _K2>
+        using key_arg           = typename base::template key_arg<_K2>;
+
+
+        // flat_map
+        flat_map                                    () = default;
+        explicit flat_map                           ( size_t count, const _Hash& hash = _Hash(), const _Equal& equal = _Equal() ) : base( count, hash, equal ) {}
+        flat_map                                    ( std::initializer_list<value_type> init ) { this->reserve( init.size() ); for ( auto& v : init ) { insert( v ); } }
+
+
+        // insert (nothing when the key exists)
+        inline std::pair<iterator, bool> insert     ( const value_type& v ) { return this->emplace_key( v.first, v.second ); }
+        inline std::pair<iterator, bool> insert     ( value_type&& v )      { return this->emplace_key( std::move( v.first ), std::move( v.second ) ); }
+
+        template<typename... _Args>
+        inline std::pair<iterator, bool> emplace    ( _Args&&... args )     { value_type v( std::forward<_Args>( args )... ); return insert( std::move( v ) ); }
+
+        // the key and the value are built only when the key is missing
+        template<typename _K2 = key_type, typename... _Args>
+        inline std::pair<iterator, bool> try_emplace( key_arg<_K2>&& key, _Args&&... args )         { return this->emplace_key( std::forward<_K2>( key ), std::forward<_Args>( args )... ); }
+        template<typename _K2 = key_type, typename... _Args>
+        inline std::pair<iterator, bool> try_emplace( const key_arg<_K2>& key, _Args&&... args )    { return this->emplace_key( key, std::forward<_Args>( args )... ); }
+
+        // insert or overwrite the value
+        template<typename _K2 = key_type, typename _V2>
+        inline std::pair<iterator, bool> insert_or_assign( key_arg<_K2>&& key, _V2&& value )
+        {
+            auto r = this->emplace_key( std::forward<_K2>( key ), std::forward<_V2>( value ) );
+            if ( !r.second )
+                r.first->second = std::forward<_V2>( value );
+            return r;
+        }
+        template<typename _K2 = key_type, typename _V2>
+        inline std::pair<iterator, bool> insert_or_assign( const key_arg<_K2>& key, _V2&& value )
+        {
+            auto r = this->emplace_key( key, std::forward<_V2>( value ) );
+            if ( !r.second )
+                r.first->second = std::forward<_V2>( value );
+            return r;
+        }
+
+
+        // [] (a default value is inserted when the key is missing)
+        template<typename _K2 = key_type>
+        inline _Value&          operator[]          ( key_arg<_K2>&& key )      { return this->emplace_key( std::forward<_K2>( key ) ).first->second; }
+        template<typename _K2 = key_type>
+        inline _Value&          operator[]          ( const key_arg<_K2>& key ) { return this->emplace_key( key ).first->second; }
+
+        // value or nullptr (no exceptions)
+        template<typename _K2 = key_type>
+        inline _Value*          get                 ( const key_arg<_K2>& key )         { auto it = this->template find<_K2>( key ); return it != this->end() ? &it->second : nullptr; }
+        template<typename _K2 = key_type>
+        inline const _Value*    get                 ( const key_arg<_K2>& key ) const   { auto it = this->template find<_K2>( key ); return it != this->end() ? &it->second : nullptr; }
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <initializer_list>
+#include <utility>
+
+#include "flat_map.h"
+
+//
+// small::flat_set<std::string> s = { "gzip", "br" };
+// s.insert( "deflate" );
+// if ( s.contains( std::string_view{ "br" } ) ) ...  // no temporary key
+// s.erase( "gzip" );
+//
+namespace small
+{
+    // open addressing hash set (the same table as flat_map, see flat_map.h)
+    template<typename _Key, typename _Hash = flat_hash, typename _Equal = flat_equal>
+    class flat_set : public flat::table<flat::set_policy<_Key>, _Hash, _Equal>
+    {
+        using base = flat::table<flat::set_policy<_Key>, _Hash, _Equal>;
+
+    public:
+        using key_type          = typename base::key_type;
+        using value_type        = typename base::value_type;
+        using iterator          = typename base::iterator;
+        using const_iterator    = typename base::const_iterator;
+
+        template<typename _K2>
+        using key_arg           = typename base::template key_arg<_K2>;
+
+
+        // flat_set
+        flat_set                                    () = default;
+        explicit flat_set                           ( size_t count, const _Hash& hash = _Hash(), const _Equal& equal = _Equal() ) : base( count, hash, equal ) {}
+        flat_set                                    ( std::initializer_list<value_type> init ) { this->reserve( init.size() ); for ( auto& k : init ) { insert( k ); } }
+
+
+        // insert (the key is built only when it is missing)
+        template<typename _K2 = key_type>
+        inline std::pair<iterator, bool> insert     ( key_arg<_K2>&& key )      { return this->emplace_key( std::forward<_K2>( key ) ); }
+        template<typename _K2 = key_type>
+        inline std::pair<iterator, bool> insert     ( const key_arg<_K2>& key ) { return this->emplace_key( key ); }
+    };
+}
@@ -1,17 +1,59 @@
 #pragma once
 
+#include "impl/hash_impl.h"
+
+//
+// unsigned long long h = small::quick_hash( "some text", 9 );         // h = h * 131 + char
+//
+// unsigned long long h64 = small::fast_hash64( data, data_length );  // word at a time, sse2 / avx2 for long inputs
+// unsigned long long s64 = small::fast_hash64( data, data_length, seed );
+// small::hash128 h128 = small::fast_hash128( data, data_length );
+//
+// for data in pieces see small::hasher (hasher.h)
+//
 namespace small
 {
     // quick hash function h = h * 131 + char
-    inline unsigned long long quick_hash            ( const char* buffer, const int length, unsigned long long start_hash = 0 )
+    inline unsigned long long quick_hash            ( const char* buffer, const size_t length, unsigned long long start_hash = 0 )
     {
         if ( buffer == nullptr )
             return start_hash;
 
-        for ( int i = 0; i < length; ++i, ++buffer )
+        for ( size_t i = 0; i < length; ++i, ++buffer )
         {
             start_hash = (start_hash << 7) + (start_hash << 1) + start_hash + (unsigned char)*buffer;
         }
         return start_hash;
     }
-}
\ No newline at end of file
+
+
+
+    // 128 bit hash value
+    struct hash128
+    {
+        unsigned long long  low     = 0;
+        unsigned long long  high    = 0;
+
+        inline bool     operator==                  ( const hash128& o ) const { return low == o.low && high == o.high; }
+        inline bool     operator!=                  ( const hash128& o ) const { return !operator==( o ); }
+    };
+
+
+    // fast 64 bit hash (not cryptographic, the same value for any simd level)
+    inline unsigned long long fast_hash64           ( const char* buffer, const size_t length, unsigned long long seed = 0 )
+    {
+        if ( buffer == nullptr && length > 0 )
+            return 0;
+        return hashing::hash64( buffer, length, seed );
+    }
+
+    // fast 128 bit hash
+    inline hash128      fast_hash128                ( const char* buffer, const size_t length, unsigned long long seed = 0 )
+    {
+        hash128 h;
+        if ( buffer == nullptr && length > 0 )
+            return h;
+        hashing::hash128( buffer, length, seed, &h.low, &h.high );
+        return h;
+    }
+}
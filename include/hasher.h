@@ -0,0 +1,150 @@
+#pragma once
+
+#include <string.h>
+
+#include <string_view>
+
+#include "hash.h"
+
+#include "buffer.h"
+#include "segmented_buffer.h"
+
+//
+// fast_hash64 / fast_hash128 computed in pieces (the same value as for the whole data)
+//
+// small::hasher h;                    // or small::hasher h( seed );
+// h.update( part1, part1_length );
+// h.update( body );                   // small::buffer, segmented_buffer, string_view
+// unsigned long long value = h.digest();
+// small::hash128 value128 = h.digest128();
+//
+namespace small
+{
+    // incremental hash (the input is kept only up to one block of 1KB)
+    class hasher
+    {
+    public:
+        hasher                                      ( unsigned long long seed = 0 ) { reset( seed ); }
+
+        // reset for a new input
+        inline void     reset                       ( unsigned long long seed = 0 )
+        {
+            seed_ = seed;
+            if ( seed == 0 )
+                memcpy( secret_, hashing::default_secret.words, sizeof( secret_ ) );
+            else
+                hashing::make_seeded_secret( secret_, seed );
+            hashing::init_accumulators( acc_ );
+            total_length_   = 0;
+            buffered_       = 0;
+        }
+
+        // bytes hashed so far
+        inline size_t   size                        () const { return total_length_; }
+
+
+        // add data
+        inline void     update                      ( const char* data, size_t length )
+        {
+            if ( data == nullptr || length == 0 )
+                return;
+            total_length_ += length;
+
+            // a block is processed only when more data follows it (the last bytes are hashed in digest)
+            if ( buffered_ + length <= hashing::block_size )
+            {
+                memcpy( buffer_ + buffered_, data, length );
+                buffered_ += length;
+                return;
+            }
+
+            if ( buffered_ > 0 )
+            {
+                size_t fill = hashing::block_size - buffered_;
+                memcpy( buffer_ + buffered_, data, fill );
+                data    += fill;
+                length  -= fill;
+                process_block( buffer_ );
+            }
+
+            while ( length > hashing::block_size )
+            {
+                process_block( data );
+                data    += hashing::block_size;
+                length  -= hashing::block_size;
+            }
+
+            memcpy( buffer_, data, length );
+            buffered_ = length;
+        }
+
+        inline void     update                      ( const std::string_view s      ) { update( s.data(), s.size() ); }
+        inline void     update                      ( const base_buffer& b          ) { update( b.data(), b.size() ); }
+        inline void     update                      ( const segmented_buffer& b     ) { b.for_each_segment( [this]( std::string_view s ) { update( s.data(), s.size() ); } ); }
+
+
+        // value for the data so far (more data can still be added)
+        inline unsigned long long digest            () const
+        {
+            if ( total_length_ <= hashing::short_max_size )
+                return hashing::hash_short( buffer_, total_length_, seed_, hashing::default_secret.words );
+
+            alignas(32) unsigned long long acc[8];
+            accumulate_tail( acc );
+            return hashing::merge_accumulators( acc, secret_, total_length_ * hashing::prime64_1 );
+        }
+
+        inline hash128  digest128                   () const
+        {
+            hash128 h;
+            if ( total_length_ <= hashing::short_max_size )
+            {
+                h.low  = hashing::hash_short( buffer_, total_length_, seed_, hashing::default_secret.words );
+                h.high = hashing::hash_short( buffer_, total_length_, seed_, hashing::default_secret.words + hashing::secret_high );
+                return h;
+            }
+
+            alignas(32) unsigned long long acc[8];
+            accumulate_tail( acc );
+            h.low  = hashing::merge_accumulators( acc, secret_, total_length_ * hashing::prime64_1 );
+            h.high = hashing::merge_accumulators( acc, secret_ + hashing::secret_high, ~(total_length_ * hashing::prime64_2) );
+            return h;
+        }
+
+    private:
+        // process a whole block and keep its last stripe (needed when less than a stripe follows)
+        inline void     process_block               ( const char* block )
+        {
+            hashing::accumulate_blocks( acc_, block, 1, secret_ );
+            memcpy( last_stripe_, block + hashing::block_size - hashing::stripe_size, hashing::stripe_size );
+        }
+
+        // accumulators with the buffered data and the last stripe
+        inline void     accumulate_tail             ( unsigned long long* acc ) const
+        {
+            memcpy( acc, acc_, sizeof( acc_ ) );
+            if ( buffered_ >= hashing::stripe_size )
+            {
+                hashing::accumulate_tail( acc, buffer_, buffered_, buffer_ + buffered_ - hashing::stripe_size, secret_ );
+            }
+            else
+            {
+                // the last stripe starts in the previous block
+                char last[hashing::stripe_size];
+                size_t from_previous = hashing::stripe_size - buffered_;
+                memcpy( last, last_stripe_ + buffered_, from_previous );
+                memcpy( last + from_previous, buffer_, buffered_ );
+                hashing::accumulate_tail( acc, buffer_, buffered_, last, secret_ );
+            }
+        }
+
+    private:
+        alignas(32) unsigned long long  acc_[8];
+        alignas(32) unsigned long long  secret_[hashing::secret_words];
+        unsigned long long              seed_           = 0;
+        size_t                          total_length_   = 0;
+        size_t                          buffered_       = 0;
+        char                            last_stripe_[hashing::stripe_size];
+        char                            buffer_[hashing::block_size];
+    };
+}
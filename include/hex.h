@@ -0,0 +1,202 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "impl/hex_impl.h"
+
+#include "buffer.h"
+
+//
+// std::string h = small::tohex_s( digest, 32 );                      // lower case
+// std::string H = small::tohex_s<small::hex::upper>( digest, 32 );
+// std::string hash = small::tohex_u64_s( small::quick_hash( data, data_length ) );
+//
+// std::string decoded = small::fromhex_s( h );
+//
+// size_t error_position = 0;
+// bool ok = small::fromhex( h, &decoded, &error_position );         // strict, any case
+//
+// small::buffer line( "id=" );
+// small::tohex_append( id, id_length, line );                       // encoded at the end, no extra copy
+//
+namespace small
+{
+    //
+    // encode in existing memory (no zero fill, no extra copy)
+    //
+
+    // encode into caller memory, returns chars written (0 if capacity is not enough)
+    template<typename _Case = hex::lower>
+    inline size_t       tohex_into                  ( const char* src, const size_t& src_length, char* hex, const size_t& capacity )
+    {
+        size_t hex_size = hex::get_hex_size( src_length );
+        if ( hex == nullptr || hex_size > capacity )
+            return 0;
+        hex::tohex<_Case>( hex, src, src_length );
+        return hex_size;
+    }
+
+    // encode at the end of buffer, returns chars added (0 if it could not be allocated)
+    template<typename _Case = hex::lower>
+    inline size_t       tohex_append                ( const char* src, const size_t& src_length, base_buffer& hex )
+    {
+        size_t hex_size = hex::get_hex_size( src_length );
+        if ( hex_size == 0 )
+            return 0;
+        char* room = hex.prepare( hex_size );
+        if ( room == nullptr )
+            return 0;
+        hex::tohex<_Case>( room, src, src_length );
+        hex.commit( hex_size );
+        return hex_size;
+    }
+
+    // encode at the end of string, returns chars added
+    template<typename _Case = hex::lower>
+    inline size_t       tohex_append                ( const char* src, const size_t& src_length, std::string& hex )
+    {
+        size_t hex_size = hex::get_hex_size( src_length );
+        if ( hex_size == 0 )
+            return 0;
+        size_t from = hex.size();
+#if defined(__cpp_lib_string_resize_and_overwrite)
+        hex.resize_and_overwrite( from + hex_size, [&]( char* p, size_t /*n*/ ) { hex::tohex<_Case>( p + from, src, src_length ); return from + hex_size; } );
+#else
+        hex.resize( from + hex_size );
+        hex::tohex<_Case>( hex.data() + from, src, src_length );
+#endif
+        return hex_size;
+    }
+
+    // encode at the end
+    template<typename _Case = hex::lower, typename T>
+    inline size_t       tohex_append                ( const std::string& src, T& hex ) { return tohex_append<_Case>( src.c_str(), src.size(), hex ); }
+
+
+
+
+    //
+    // implementations for common data
+    //
+
+    // tohex (hex::lower or hex::upper)
+    template<typename _Case = hex::lower, typename T>
+    inline void         tohex                       ( const char* src, const size_t& src_length, T* hex )
+    {
+        if ( hex == nullptr )
+            return;
+
+        if constexpr ( std::is_base_of_v<small::base_buffer, T> || std::is_same_v<std::string, T> )
+        {
+            // write directly at the end of the emptied buffer
+            hex->clear();
+            tohex_append<_Case>( src, src_length, *hex );
+        }
+        else
+        {
+            hex->resize( hex::get_hex_size( src_length ) );
+            hex::tohex<_Case>( (char *)hex->data(), src, src_length );
+        }
+    }
+
+    // to hex
+    template<typename _Case = hex::lower, typename T>
+    inline void         tohex                       ( const std::string& src, T* hex ) { return tohex<_Case>( src.c_str(), src.size(), hex ); }
+
+
+    // fromhex (strict, any case), returns false on error, decoded contains what was decoded before the error
+    // error_position is the offset of the first char that is not a hex digit, or the length when it is odd
+    template<typename T>
+    inline bool         fromhex                     ( const char* hex, const size_t& hex_length, T* decoded, size_t* error_position = nullptr )
+    {
+        size_t error = hex::npos;
+        if ( decoded != nullptr )
+        {
+            size_t decoded_size = hex::get_decodedhex_size( hex_length );
+            if constexpr ( std::is_base_of_v<small::base_buffer, T> )
+            {
+                decoded->clear();
+                char* room = decoded->prepare( decoded_size );
+                if ( room == nullptr )
+                    return false;
+                decoded->commit( hex::fromhex( room, hex, hex_length, &error ) );
+            }
+            else
+            {
+                decoded->resize( decoded_size );
+                size_t decoded_length = hex::fromhex( (char*)decoded->data(), hex, hex_length, &error );
+                decoded->resize( decoded_length );
+            }
+        }
+
+        if ( error_position )
+            *error_position = error;
+        return error == hex::npos;
+    }
+
+    // fromhex
+    template<typename T>
+    inline bool         fromhex                     ( const std::string& hex, T* decoded, size_t* error_position = nullptr ) { return fromhex( hex.c_str(), hex.size(), decoded, error_position ); }
+
+
+
+
+
+    //////////////////////////////////////////////////////////////////////////
+    // as string
+    template<typename _Case = hex::lower>
+    inline std::string  tohex_s                     ( const char* src, const size_t& src_length ) { std::string hex; tohex<_Case>( src, src_length, &hex ); return hex; }
+    template<typename _Case = hex::lower>
+    inline std::string  tohex_s                     ( const std::string&       src           ) { return tohex_s<_Case>( src.c_str(), src.size() ); }
+    template<typename _Case = hex::lower>
+    inline std::string  tohex_s                     ( const std::vector<char>& src           ) { return tohex_s<_Case>( src.data(),  src.size() ); }
+    template<typename _Case = hex::lower>
+    inline std::string  tohex_s                     ( const small::buffer&     src           ) { return tohex_s<_Case>( src.data(),  src.size() ); }
+
+    // 64 bit value (quick_hash, ...) as 16 hex digits
+    template<typename _Case = hex::lower>
+    inline std::string  tohex_u64_s                 ( const unsigned long long& value ) { std::string hex( 16, '\0' ); hex::tohex_u64<_Case>( hex.data(), value ); return hex; }
+
+    // as buffer vector<char>
+    template<typename _Case = hex::lower>
+    inline std::vector<char> tohex_v                ( const char* src, const size_t& src_length ) { std::vector<char> hex; tohex<_Case>( src, src_length, &hex ); return hex; }
+    template<typename _Case = hex::lower>
+    inline std::vector<char> tohex_v                ( const std::string&       src           ) { return tohex_v<_Case>( src.c_str(), src.size() ); }
+    template<typename _Case = hex::lower>
+    inline std::vector<char> tohex_v                ( const std::vector<char>& src           ) { return tohex_v<_Case>( src.data(),  src.size() ); }
+    template<typename _Case = hex::lower>
+    inline std::vector<char> tohex_v                ( const small::buffer&     src           ) { return tohex_v<_Case>( src.data(),  src.size() ); }
+
+    // as buffer
+    template<typename _Case = hex::lower>
+    inline small::buffer tohex_b                    ( const char* src, const size_t& src_length ) { small::buffer hex; tohex<_Case>( src, src_length, &hex ); return hex; }
+    template<typename _Case = hex::lower>
+    inline small::buffer tohex_b                    ( const std::string&       src           ) { return tohex_b<_Case>( src.c_str(), src.size() ); }
+    template<typename _Case = hex::lower>
+    inline small::buffer tohex_b                    ( const std::vector<char>& src           ) { return tohex_b<_Case>( src.data(),  src.size() ); }
+    template<typename _Case = hex::lower>
+    inline small::buffer tohex_b                    ( const small::buffer&     src           ) { return tohex_b<_Case>( src.data(),  src.size() ); }
+
+
+
+
+    // from hex_s
+    inline std::string  fromhex_s                   ( const char* hex, const size_t& hex_length ) { std::string decoded; fromhex( hex, hex_length, &decoded ); return decoded; }
+    inline std::string  fromhex_s                   ( const std::string&        hex          ) { return fromhex_s( hex.c_str(), hex.size() ); }
+    inline std::string  fromhex_s                   ( const std::vector<char>&  hex          ) { return fromhex_s( hex.data(),  hex.size() ); }
+    inline std::string  fromhex_s                   ( const small::buffer&      hex          ) { return fromhex_s( hex.data(),  hex.size() ); }
+
+    // fromhex_v
+    inline std::vector<char> fromhex_v              ( const char* hex, const size_t& hex_length ) { std::vector<char> decoded; fromhex( hex, hex_length, &decoded ); return decoded; }
+    inline std::vector<char> fromhex_v              ( const std::string&        hex          ) { return fromhex_v( hex.c_str(), hex.size() ); }
+    inline std::vector<char> fromhex_v              ( const std::vector<char>&  hex          ) { return fromhex_v( hex.data(),  hex.size() ); }
+    inline std::vector<char> fromhex_v              ( const small::buffer&      hex          ) { return fromhex_v( hex.data(),  hex.size() ); }
+
+    // fromhex_b
+    inline small::buffer fromhex_b                  ( const char* hex, const size_t& hex_length ) { small::buffer decoded; fromhex( hex, hex_length, &decoded ); return decoded; }
+    inline small::buffer fromhex_b                  ( const std::string&        hex          ) { return fromhex_b( hex.c_str(), hex.size() ); }
+    inline small::buffer fromhex_b                  ( const std::vector<char>&  hex          ) { return fromhex_b( hex.data(),  hex.size() ); }
+    inline small::buffer fromhex_b                  ( const small::buffer&      hex          ) { return fromhex_b( hex.data(),  hex.size() ); }
+}
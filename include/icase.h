@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string_view>
+
+#include "impl/case_impl.h"
+#include "hash.h"
+#include "hasher.h"
+#include "flat_map.h"
+#include "flat_set.h"
+
+//
+// case insensitive (A-Z) hash and equal, for header like keys (see util.h for to_lower_inplace, iequals, strnicmp)
+//
+// unsigned long long h = small::fast_hash64_icase( "Content-Type", 12 );  // == small::fast_hash64( "content-type", 12 )
+//
+// small::icase_flat_map<std::string, int> headers;
+// headers["Content-Type"] = 1;
+// auto it = headers.find( std::string_view{ "content-type" } );
+//
+// small::icase_flat_set<std::string> methods = { "GET", "POST" };
+// bool b = methods.contains( "get" );
+//
+// std::unordered_map<std::string, int, small::icase_hash, small::icase_equal> m;
+//
+namespace small
+{
+    // fast_hash64 of the lower case text (only A-Z change, like stricmp)
+    inline unsigned long long fast_hash64_icase     ( const char* buffer, const size_t length, unsigned long long seed = 0 )
+    {
+        if ( buffer == nullptr && length > 0 )
+            return 0;
+
+        // header like keys are folded on the stack, longer ones in pieces
+        char folded[256];
+        if ( length <= sizeof( folded ) )
+        {
+            ascii::lower_copy( folded, buffer, length );
+            return fast_hash64( folded, length, seed );
+        }
+
+        hasher h( seed );
+        for ( size_t done = 0; done < length; )
+        {
+            size_t n = length - done < sizeof( folded ) ? length - done : sizeof( folded );
+            ascii::lower_copy( folded, buffer + done, n );
+            h.update( folded, n );
+            done += n;
+        }
+        return h.digest();
+    }
+
+
+    // hash that ignores the case (transparent, buffers and strings can be looked up with string_view)
+    struct icase_hash
+    {
+        using is_transparent = void;
+        using is_avalanching = void;
+
+        inline size_t   operator()                  ( const std::string_view s ) const { return (size_t)fast_hash64_icase( s.data(), s.size() ); }
+    };
+
+    // equal that ignores the case (matches icase_hash)
+    struct icase_equal
+    {
+        using is_transparent = void;
+
+        inline bool     operator()                  ( const std::string_view a, const std::string_view b ) const { return a.size() == b.size() && ascii::equals( a.data(), b.data(), a.size() ); }
+    };
+
+
+    // case insensitive flat map / set
+    template<typename _Key, typename _Value>
+    using icase_flat_map    = flat_map<_Key, _Value, icase_hash, icase_equal>;
+
+    template<typename _Key>
+    using icase_flat_set    = flat_set<_Key, icase_hash, icase_equal>;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "base32_simd_impl.h"
+
+
+namespace small
+{
+    namespace base32
+    {
+        // error position when there is no error
+        const size_t npos = (size_t)-1;
+
+        // chars used for the last 1..4 bytes of a group (without padding)
+        inline size_t   get_tail_chars              ( size_t bytes ) { static const unsigned char tail[5] = { 0, 2, 4, 5, 7 }; return tail[bytes]; }
+
+
+        // get base32 buffer needed size (without null ending char)
+        template<typename _Variant = standard>
+        inline size_t   get_base32_size             ( const size_t& length )
+        {
+            return _Variant::padding ? ((length + 4) / 5) * 8 : (length / 5) * 8 + get_tail_chars( length % 5 );
+        }
+
+        // to base32 one group at a time (reference implementation, also used for the tail after simd)
+        template<typename _Alphabet = alphabet_standard, bool _Padding = true>
+        inline void     tobase32_scalar             ( char* base32, const char* src, const size_t& src_length )
+        {
+            const unsigned char* s = (const unsigned char*)src;
+            size_t length = src_length;
+            for ( ; length >= 5; length -= 5, s += 5 )
+            {
+                unsigned long long group = (unsigned long long)s[0] << 32 | (unsigned long long)s[1] << 24 | (unsigned long long)s[2] << 16 | (unsigned long long)s[3] << 8 | s[4];
+                for ( int i = 7; i >= 0; --i, group >>= 5 )
+                    base32[i] = _Alphabet::chars[group & 0x1f];
+                base32 += 8;
+            }
+
+            // still left something
+            if ( length > 0 )
+            {
+                unsigned long long group = 0;
+                for ( size_t i = 0; i < 5; ++i )
+                    group = group << 8 | (i < length ? s[i] : 0);
+
+                size_t chars = get_tail_chars( length );
+                for ( size_t i = 0; i < chars; ++i )
+                    base32[i] = _Alphabet::chars[(group >> (35 - 5 * i)) & 0x1f];
+
+                //  add '='
+                if constexpr ( _Padding )
+                {
+                    for ( size_t i = chars; i < 8; ++i )
+                        base32[i] = '=';
+                }
+            }
+        }
+
+        // to base32 (buffer must be proper allocated using get_base32_size)
+        template<typename _Variant = standard>
+        inline void     tobase32                    ( char* base32, const char* src, const size_t& src_length )
+        {
+            using alphabet = typename _Variant::alphabet;
+            // whole blocks with simd (multiple of 5 bytes) then the rest
+            size_t done = tobase32_simd<alphabet>( base32, src, src_length );
+            tobase32_scalar<alphabet, _Variant::padding>( base32 + done / 5 * 8, src + done, src_length - done );
+        }
+
+
+
+
+        // get aprox size
+        inline size_t   get_decodedbase32_size      ( const size_t& base32_length )
+        {
+            return ((base32_length + 7) / 8) * 5;
+        }
+
+        // decode base32 (strict), stops at the first char outside the alphabet (returns decoded length)
+        // with padding the length must be a multiple of 8 and '=' only completes the last group,
+        // without padding '=' is not allowed and the last group can have 2, 4, 5 or 7 chars
+        // the unused bits of the last char of a group must be 0
+        // error_position is set to the offset of the rejected char, to base32_length when the
+        // data ends in the middle of a group, or to npos when there is no error
+        template<typename _Variant = standard>
+        inline size_t   frombase32                  ( char* decoded, const char* base32, const size_t& base32_length, size_t* error_position = nullptr )
+        {
+            using alphabet = typename _Variant::alphabet;
+            const signed char* index = alphabet_index<alphabet>::table.index;
+
+            size_t done = frombase32_simd<alphabet>( decoded, base32, base32_length );
+            char* out = decoded + done / 8 * 5;
+
+            size_t              error = npos;
+            unsigned long long  group = 0;
+            size_t              count = 0;
+            for ( ; done < base32_length; ++done )
+            {
+                int value = index[(unsigned char)base32[done]];
+                if ( value < 0 )
+                    break;
+
+                group = group << 5 | (unsigned int)value;
+                if ( ++count == 8 )
+                {
+                    for ( int i = 4; i >= 0; --i, group >>= 8 )
+                        out[i] = (char)(group & 0xff);
+                    out  += 5;
+                    group = 0;
+                    count = 0;
+                }
+            }
+
+            // last group
+            bool tail_valid = count == 0 || get_tail_chars( count * 5 / 8 ) == count;
+            bool tail_bits  = count == 0 || (group & ((1ULL << (count * 5 % 8)) - 1)) == 0;
+            if ( tail_valid && !tail_bits && (done == base32_length || base32[done] == '=') )
+            {
+                error = done - 1;
+            }
+            else if ( done < base32_length )
+            {
+                // padding completes the last group and ends the data
+                if ( base32[done] != '=' || !_Variant::padding || count == 0 || !tail_valid )
+                    error = done;
+                else
+                {
+                    size_t pad = done;
+                    for ( size_t k = count; k < 8; ++k, ++pad )
+                    {
+                        if ( pad >= base32_length )
+                        {
+                            error = base32_length;
+                            break;
+                        }
+                        if ( base32[pad] != '=' )
+                        {
+                            error = pad;
+                            break;
+                        }
+                    }
+                    if ( error == npos && pad < base32_length )
+                        error = pad;
+                }
+            }
+            else if ( count > 0 && (_Variant::padding || !tail_valid) )
+            {
+                error = base32_length;
+            }
+
+            // bytes of the last group (also when the padding is wrong, like the decoded data before an error)
+            if ( count > 0 && tail_valid )
+            {
+                size_t bytes = count * 5 / 8;
+                group <<= 40 - count * 5;
+                for ( size_t i = 0; i < bytes; ++i )
+                    out[i] = (char)((group >> (32 - 8 * i)) & 0xff);
+                out += bytes;
+            }
+
+            if ( error_position )
+                *error_position = error;
+            return (size_t)(out - decoded);
+        }
+    }
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu_impl.h"
+
+//
+// base32 alphabets (rfc 4648) and vectorized kernels
+// each kernel processes only whole blocks and returns how many input bytes were consumed
+// (a multiple of 5 when encoding, of 8 when decoding), the rest is done by the scalar code
+//
+// small::base32::standard     // A-Z 2-7 with padding
+// small::base32::hex          // 0-9 A-V with padding (extended hex, sort order is kept)
+// small::base32::standard_nopad, small::base32::hex_nopad
+//
+namespace small
+{
+    namespace base32
+    {
+        // A-Z 2-7
+        struct alphabet_standard
+        {
+            static constexpr char   chars[33]   = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+            // 2 ranges of chars (for the simd decoders)
+            static constexpr char   first0      = 'A';
+            static constexpr int    count0      = 26;
+            static constexpr char   first1      = '2';
+        };
+
+        // 0-9 A-V
+        struct alphabet_hex
+        {
+            static constexpr char   chars[33]   = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+            static constexpr char   first0      = '0';
+            static constexpr int    count0      = 10;
+            static constexpr char   first1      = 'A';
+        };
+
+
+        // index of each char in alphabet (-1 when not in alphabet)
+        template<typename _Alphabet>
+        struct alphabet_index
+        {
+            struct table_type
+            {
+                signed char     index[256];
+            };
+
+            static constexpr table_type make        ()
+            {
+                table_type t = {};
+                for ( int i = 0; i < 256; ++i )
+                    t.index[i] = -1;
+                for ( int i = 0; i < 32; ++i )
+                    t.index[(unsigned char)_Alphabet::chars[i]] = (signed char)i;
+                return t;
+            }
+
+            alignas(64) static constexpr table_type table = make();
+        };
+
+
+        // variant (alphabet, padding)
+        template<typename _Alphabet = alphabet_standard, bool _Padding = true>
+        struct variant
+        {
+            using alphabet = _Alphabet;
+            static constexpr bool   padding     = _Padding;
+        };
+
+        using standard          = variant<alphabet_standard, true>;
+        using standard_nopad    = variant<alphabet_standard, false>;
+        using hex               = variant<alphabet_hex, true>;
+        using hex_nopad         = variant<alphabet_hex, false>;
+
+
+
+
+#if defined(SMALL_SIMD_X86)
+        //
+        // encode
+        //
+
+        // 16 bytes with 5 source bytes at offset 0 -> 8 x 5 bit indexes (one per 16 bit word)
+        SMALL_TARGET("ssse3")
+        inline __m128i  enc_reshuffle_ssse3         ( __m128i in )
+        {
+            // for each index the 2 bytes that hold it (big endian word), then shift right by 11 6 9 4 7 10 5 8
+            in = _mm_shuffle_epi8( in, _mm_setr_epi8( 1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, 5, 4 ) );
+            in = _mm_mulhi_epu16( in, _mm_setr_epi16( 1 << 5, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8 ) );
+            return _mm_and_si128( in, _mm_set1_epi16( 0x1f ) );
+        }
+
+        // 5 bit indexes -> base32 chars
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline __m128i  enc_translate_ssse3         ( __m128i indexes )
+        {
+            // 0..15 from the first table, 16..31 from the second (shuffle gives 0 when bit 7 is set)
+            const __m128i lut0 = _mm_loadu_si128( (const __m128i*)_Alphabet::chars );
+            const __m128i lut1 = _mm_loadu_si128( (const __m128i*)(_Alphabet::chars + 16) );
+            const __m128i c0 = _mm_shuffle_epi8( lut0, _mm_adds_epu8( indexes, _mm_set1_epi8( 0x70 ) ) );
+            const __m128i c1 = _mm_shuffle_epi8( lut1, _mm_sub_epi8( indexes, _mm_set1_epi8( 16 ) ) );
+            return _mm_or_si128( c0, c1 );
+        }
+
+        // encode blocks of 10 bytes (reads 21)
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline size_t   tobase32_ssse3              ( char* base32, const char* src, size_t src_length )
+        {
+            size_t done = 0;
+            while ( src_length - done >= 21 )
+            {
+                const __m128i g0 = enc_reshuffle_ssse3( _mm_loadu_si128( (const __m128i*)(src + done) ) );
+                const __m128i g1 = enc_reshuffle_ssse3( _mm_loadu_si128( (const __m128i*)(src + done + 5) ) );
+                _mm_storeu_si128( (__m128i*)base32, enc_translate_ssse3<_Alphabet>( _mm_packus_epi16( g0, g1 ) ) );
+                base32  += 16;
+                done    += 10;
+            }
+            return done;
+        }
+
+
+        // encode blocks of 20 bytes (reads 31)
+        template<typename _Alphabet>
+        SMALL_TARGET("avx2")
+        inline size_t   tobase32_avx2               ( char* base32, const char* src, size_t src_length )
+        {
+            const __m256i shuffle   = _mm256_setr_epi8( 1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, 5, 4,
+                                                        1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, 5, 4 );
+            const __m256i shift     = _mm256_setr_epi16( 1 << 5, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8,
+                                                         1 << 5, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8 );
+            const __m256i mask_1f   = _mm256_set1_epi16( 0x1f );
+            const __m256i lut0      = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)_Alphabet::chars ) );
+            const __m256i lut1      = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)(_Alphabet::chars + 16) ) );
+
+            size_t done = 0;
+            while ( src_length - done >= 31 )
+            {
+                // one group of 5 bytes in each lane (groups 0 1 and 2 3)
+                const char* p = src + done;
+                __m256i g01 = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*)p ) ),        _mm_loadu_si128( (const __m128i*)(p + 5) ),  1 );
+                __m256i g23 = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*)(p + 10) ) ), _mm_loadu_si128( (const __m128i*)(p + 15) ), 1 );
+                g01 = _mm256_and_si256( _mm256_mulhi_epu16( _mm256_shuffle_epi8( g01, shuffle ), shift ), mask_1f );
+                g23 = _mm256_and_si256( _mm256_mulhi_epu16( _mm256_shuffle_epi8( g23, shuffle ), shift ), mask_1f );
+
+                // the pack is in lane (0 2 1 3), put the groups back in order
+                const __m256i indexes = _mm256_permute4x64_epi64( _mm256_packus_epi16( g01, g23 ), 0xd8 );
+                const __m256i c0 = _mm256_shuffle_epi8( lut0, _mm256_adds_epu8( indexes, _mm256_set1_epi8( 0x70 ) ) );
+                const __m256i c1 = _mm256_shuffle_epi8( lut1, _mm256_sub_epi8( indexes, _mm256_set1_epi8( 16 ) ) );
+                _mm256_storeu_si256( (__m256i*)base32, _mm256_or_si256( c0, c1 ) );
+                base32  += 32;
+                done    += 20;
+            }
+            return done;
+        }
+
+
+
+
+        //
+        // decode
+        //
+
+        // base32 chars -> 5 bit values, returns false if any char is not in the alphabet ('=' included)
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline bool     dec_translate_ssse3         ( __m128i& in )
+        {
+            // 2 ranges (unsigned x <= max is min(x, max) == x)
+            const __m128i r0    = _mm_sub_epi8( in, _mm_set1_epi8( _Alphabet::first0 ) );
+            const __m128i r1    = _mm_sub_epi8( in, _mm_set1_epi8( _Alphabet::first1 ) );
+            const __m128i is_r0 = _mm_cmpeq_epi8( _mm_min_epu8( r0, _mm_set1_epi8( _Alphabet::count0 - 1 ) ), r0 );
+            const __m128i is_r1 = _mm_cmpeq_epi8( _mm_min_epu8( r1, _mm_set1_epi8( 31 - _Alphabet::count0 ) ), r1 );
+            if ( _mm_movemask_epi8( _mm_or_si128( is_r0, is_r1 ) ) != 0xffff )
+                return false;
+
+            in = _mm_or_si128( _mm_and_si128( is_r0, r0 ), _mm_and_si128( is_r1, _mm_add_epi8( r1, _mm_set1_epi8( _Alphabet::count0 ) ) ) );
+            return true;
+        }
+
+        // 16 x 5 bit values -> 10 bytes at the start of the register
+        SMALL_TARGET("ssse3")
+        inline __m128i  dec_pack_ssse3              ( __m128i in )
+        {
+            // pairs -> 10 bits, pairs of pairs -> 20 bits, then 40 bits in each 64 bit lane (big endian bytes)
+            const __m128i w = _mm_maddubs_epi16( in, _mm_set1_epi16( 0x0120 ) );
+            const __m128i d = _mm_madd_epi16( w, _mm_set1_epi32( 0x00010400 ) );
+            const __m128i q = _mm_or_si128( _mm_slli_epi64( d, 20 ), _mm_srli_epi64( d, 32 ) );
+            return _mm_shuffle_epi8( q, _mm_setr_epi8( 4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1 ) );
+        }
+
+        // decode blocks of 16 chars -> 10 bytes
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline size_t   frombase32_ssse3            ( char* decoded, const char* base32, size_t base32_length )
+        {
+            size_t done = 0;
+            while ( base32_length - done >= 16 )
+            {
+                __m128i in = _mm_loadu_si128( (const __m128i*)(base32 + done) );
+                if ( !dec_translate_ssse3<_Alphabet>( in ) )
+                    break;
+
+                const __m128i out = dec_pack_ssse3( in );
+                _mm_storel_epi64( (__m128i*)decoded, out );
+                short last = (short)_mm_extract_epi16( out, 4 );
+                memcpy( decoded + 8, &last, 2 );
+                decoded += 10;
+                done    += 16;
+            }
+            return done;
+        }
+
+
+        // base32 chars -> 5 bit values, returns false if any char is not in the alphabet ('=' included)
+        template<typename _Alphabet>
+        SMALL_TARGET("avx2")
+        inline bool     dec_translate_avx2          ( __m256i& in )
+        {
+            const __m256i r0    = _mm256_sub_epi8( in, _mm256_set1_epi8( _Alphabet::first0 ) );
+            const __m256i r1    = _mm256_sub_epi8( in, _mm256_set1_epi8( _Alphabet::first1 ) );
+            const __m256i is_r0 = _mm256_cmpeq_epi8( _mm256_min_epu8( r0, _mm256_set1_epi8( _Alphabet::count0 - 1 ) ), r0 );
+            const __m256i is_r1 = _mm256_cmpeq_epi8( _mm256_min_epu8( r1, _mm256_set1_epi8( 31 - _Alphabet::count0 ) ), r1 );
+            if ( (unsigned int)_mm256_movemask_epi8( _mm256_or_si256( is_r0, is_r1 ) ) != 0xffffffffu )
+                return false;
+
+            in = _mm256_or_si256( _mm256_and_si256( is_r0, r0 ), _mm256_and_si256( is_r1, _mm256_add_epi8( r1, _mm256_set1_epi8( _Alphabet::count0 ) ) ) );
+            return true;
+        }
+
+        // decode blocks of 32 chars -> 20 bytes
+        template<typename _Alphabet>
+        SMALL_TARGET("avx2")
+        inline size_t   frombase32_avx2             ( char* decoded, const char* base32, size_t base32_length )
+        {
+            const __m256i pack = _mm256_setr_epi8( 4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1,
+                                                   4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1 );
+
+            size_t done = 0;
+            while ( base32_length - done >= 32 )
+            {
+                __m256i in = _mm256_loadu_si256( (const __m256i*)(base32 + done) );
+                if ( !dec_translate_avx2<_Alphabet>( in ) )
+                    break;
+
+                const __m256i w = _mm256_maddubs_epi16( in, _mm256_set1_epi16( 0x0120 ) );
+                const __m256i d = _mm256_madd_epi16( w, _mm256_set1_epi32( 0x00010400 ) );
+                const __m256i q = _mm256_or_si256( _mm256_slli_epi64( d, 20 ), _mm256_srli_epi64( d, 32 ) );
+                const __m256i out = _mm256_shuffle_epi8( q, pack );
+
+                // 10 bytes from each lane (the second store overwrites the 6 extra bytes of the first)
+                const __m128i hi = _mm256_extracti128_si256( out, 1 );
+                _mm_storeu_si128( (__m128i*)decoded, _mm256_castsi256_si128( out ) );
+                _mm_storel_epi64( (__m128i*)(decoded + 10), hi );
+                short last = (short)_mm_extract_epi16( hi, 4 );
+                memcpy( decoded + 18, &last, 2 );
+                decoded += 20;
+                done    += 32;
+            }
+            return done;
+        }
+#endif // SMALL_SIMD_X86
+
+
+        // encode whole blocks with the best kernel available (returns source bytes consumed)
+        template<typename _Alphabet = alphabet_standard>
+        inline size_t   tobase32_simd               ( char* base32, const char* src, size_t src_length )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:
+            case cpu::EnumSimdLevel::kSimd_AVX2:    return tobase32_avx2 <_Alphabet>( base32, src, src_length );
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   return tobase32_ssse3<_Alphabet>( base32, src, src_length );
+            default: break;
+            }
+#endif
+            (void)base32; (void)src; (void)src_length;
+            return 0;
+        }
+
+        // decode whole blocks of valid chars with the best kernel available (returns base32 chars consumed,
+        // always a multiple of 8, it stops at the first block with a char outside the alphabet, '=' included)
+        template<typename _Alphabet = alphabet_standard>
+        inline size_t   frombase32_simd             ( char* decoded, const char* base32, size_t base32_length )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:
+            case cpu::EnumSimdLevel::kSimd_AVX2:    return frombase32_avx2 <_Alphabet>( decoded, base32, base32_length );
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   return frombase32_ssse3<_Alphabet>( decoded, base32, base32_length );
+            default: break;
+            }
+#endif
+            (void)decoded; (void)base32; (void)base32_length;
+            return 0;
+        }
+    }
+}
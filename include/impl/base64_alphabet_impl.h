@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stddef.h>
+
+//
+// base64 alphabets and variants selected at compile time
+//
+// small::base64::standard     // +/ with padding
+// small::base64::url          // -_ with padding
+// small::base64::url_nopad    // -_ without padding (jwt)
+// small::base64::mime         // +/ with padding and lines of 76 chars separated by CRLF
+//
+// small::base64::variant<small::base64::alphabet_url, false/*padding*/, 64/*line length*/>
+//
+// // custom alphabet (64 ascii chars)
+// struct my_alphabet : small::base64::alphabet_custom
+// {
+//     static constexpr char chars[65] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz.-";
+// };
+//
+namespace small
+{
+    namespace base64
+    {
+        // alphabets where 0..61 are A-Z a-z 0-9 and only the last 2 chars change (all simd kernels)
+        template<char _C62, char _C63>
+        struct alphabet_ordered
+        {
+            static constexpr bool   ordered = true;
+            static constexpr char   c62     = _C62;
+            static constexpr char   c63     = _C63;
+            static constexpr char   chars[65] =
+            {
+                'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+                'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+                '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', _C62, _C63, 0
+            };
+        };
+
+        // standard alphabet
+        using alphabet_standard = alphabet_ordered<'+', '/'>;
+        // url and filename safe alphabet
+        using alphabet_url      = alphabet_ordered<'-', '_'>;
+
+        // base for custom alphabets, derive and define chars (only the avx-512 kernels are used for them)
+        struct alphabet_custom
+        {
+            static constexpr bool   ordered = false;
+            static constexpr char   c62     = 0;
+            static constexpr char   c63     = 0;
+        };
+
+
+
+        // index of each char in alphabet (-1 when not in alphabet)
+        template<typename _Alphabet>
+        struct alphabet_index
+        {
+            struct table_type
+            {
+                signed char     index[256];     // for scalar code
+                unsigned char   lookup[128];    // 0x80 when not in alphabet (for the avx-512 kernels)
+            };
+
+            static constexpr bool   is_valid    ()
+            {
+                // 64 different ascii chars, '=' is for padding
+                bool seen[128] = {};
+                for ( int i = 0; i < 64; ++i )
+                {
+                    unsigned char ch = (unsigned char)_Alphabet::chars[i];
+                    if ( ch == 0 || ch >= 128 || ch == '=' || seen[ch] )
+                        return false;
+                    seen[ch] = true;
+                }
+                return true;
+            }
+
+            static constexpr table_type make    ()
+            {
+                table_type t = {};
+                for ( int i = 0; i < 256; ++i )
+                    t.index[i] = -1;
+                for ( int i = 0; i < 128; ++i )
+                    t.lookup[i] = 0x80;
+                for ( int i = 0; i < 64; ++i )
+                {
+                    t.index[(unsigned char)_Alphabet::chars[i]] = (signed char)i;
+                    t.lookup[(unsigned char)_Alphabet::chars[i]] = (unsigned char)i;
+                }
+                return t;
+            }
+
+            static_assert( is_valid(), "a base64 alphabet needs 64 different ascii chars and no '='" );
+
+            alignas(64) static constexpr table_type table = make();
+        };
+
+
+
+        // variant (alphabet, padding, line length or 0 for no wrapping, lines are separated by CRLF)
+        template<typename _Alphabet = alphabet_standard, bool _Padding = true, size_t _LineLength = 0>
+        struct variant
+        {
+            using alphabet = _Alphabet;
+            static constexpr bool   padding     = _Padding;
+            static constexpr size_t line_length = _LineLength;
+
+            static_assert( _LineLength % 4 == 0, "base64 line length must be a multiple of 4" );
+        };
+
+        using standard          = variant<alphabet_standard, true>;
+        using standard_nopad    = variant<alphabet_standard, false>;
+        using url               = variant<alphabet_url, true>;
+        using url_nopad         = variant<alphabet_url, false>;
+        using mime              = variant<alphabet_standard, true, 76>;
+    }
+}
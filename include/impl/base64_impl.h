@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 
+#include "base64_simd_impl.h"
+
 
 namespace small
 {
@@ -70,13 +72,18 @@ namespace small
         //
         // get base64 buffer needed size (without null ending char)
         // 
+        template<typename _Variant = standard>
         inline size_t   get_base64_size             ( const size_t& length )
         {
-            return ((length + 2) / 3) * 4;
+            size_t size = _Variant::padding ? ((length + 2) / 3) * 4 : (length / 3) * 4 + (length % 3 > 0 ? length % 3 + 1 : 0);
+            if constexpr ( _Variant::line_length > 0 )
+                size += size > 0 ? (size - 1) / _Variant::line_length * 2 : 0; // CRLF between lines
+            return size;
         }
 
-        // to base64 (buffer must be proper allocated using get_base64_size + 1)
-        inline bool     tobase64                    ( char* base64, const char* src, const size_t& src_length )
+        // to base64 one byte at a time (reference implementation, also used for the tail after simd)
+        template<typename _Alphabet = alphabet_standard, bool _Padding = true>
+        inline bool     tobase64_scalar             ( char* base64, const char* src, const size_t& src_length )
         {
             unsigned int    encoded_word = 0;
             int             count_bits = 0;
@@ -98,7 +105,7 @@ namespace small
                     count_bits -= 6;
                     base64_index = 0x3F & (encoded_word >> (count_bits));
 
-                    ch = get_base64char_at( base64_index );
+                    ch = _Alphabet::chars[base64_index];
                     *base64++ = ch;
                 }
             }
@@ -112,17 +119,57 @@ namespace small
                 count_bits -= 6;
                 base64_index = 0x3F & (encoded_word >> (count_bits));
 
-                ch = get_base64char_at( base64_index );
+                ch = _Alphabet::chars[base64_index];
                 *base64++ = ch;
 
                 //  add '='
-                for ( int k = multiple; k < 3; k++ )
-                    *base64++ = '=';
+                if constexpr ( _Padding )
+                {
+                    for ( int k = multiple; k < 3; k++ )
+                        *base64++ = '=';
+                }
             }
             
             return true;
         }
 
+        // to base64 without line wrapping
+        template<typename _Alphabet = alphabet_standard, bool _Padding = true>
+        inline void     tobase64_line               ( char* base64, const char* src, const size_t& src_length )
+        {
+            // whole blocks with simd (multiple of 3 bytes) then the rest
+            size_t done = tobase64_simd<_Alphabet>( base64, src, src_length );
+            tobase64_scalar<_Alphabet, _Padding>( base64 + done / 3 * 4, src + done, src_length - done );
+        }
+
+        // to base64 (buffer must be proper allocated using get_base64_size + 1)
+        template<typename _Variant = standard>
+        inline bool     tobase64                    ( char* base64, const char* src, const size_t& src_length )
+        {
+            using alphabet = typename _Variant::alphabet;
+            if constexpr ( _Variant::line_length == 0 )
+            {
+                tobase64_line<alphabet, _Variant::padding>( base64, src, src_length );
+            }
+            else
+            {
+                // whole lines separated by CRLF then the last one
+                const size_t line_bytes = _Variant::line_length / 4 * 3;
+                size_t length = src_length;
+                while ( length > line_bytes )
+                {
+                    tobase64_line<alphabet, _Variant::padding>( base64, src, line_bytes );
+                    base64 += _Variant::line_length;
+                    *base64++ = '\r';
+                    *base64++ = '\n';
+                    src     += line_bytes;
+                    length  -= line_bytes;
+                }
+                tobase64_line<alphabet, _Variant::padding>( base64, src, length );
+            }
+            return true;
+        }
+
 
 
 
@@ -132,13 +179,29 @@ namespace small
             return ((base64_length + 3) / 4) * 3;
         }
 
-        // decode from base 64 (returns length)
-        inline size_t   frombase64                  ( char* decoded_buffer, const char* base64, const size_t& base64_length )
+        // decode validation mode
+        enum class EnumBase64Mode
         {
-            size_t  decoded_length = 0;
+            kBase64_SkipInvalid,    // skip any char outside the alphabet and stop at the first '='
+            kBase64_Strict,         // stop at the first char outside the alphabet (only '=' padding at the end is allowed)
+            kBase64_Lenient,        // like strict but ascii whitespace (CR, LF, ...) is skipped
+        };
+
+        // error position when there is no error
+        const size_t npos = (size_t)-1;
+
+        // ascii whitespace
+        inline bool     is_base64_space             ( char ch ) { return ch == ' ' || ch == '\r' || ch == '\n' || ch == '\t' || ch == '\v' || ch == '\f'; }
 
-            int     decoded_word = 0;
-            int     count_bits = 0;
+
+        // decode from base 64 one char at a time skipping invalid chars (reference implementation, returns length)
+        template<typename _Alphabet = alphabet_standard>
+        inline size_t   frombase64_scalar           ( char* decoded_buffer, const char* base64, const size_t& base64_length )
+        {
+            size_t          decoded_length = 0;
+
+            unsigned int    decoded_word = 0;
+            int             count_bits = 0;
 
             for ( size_t i = 0; i < base64_length; ++i, ++base64 )
             {
@@ -147,11 +210,11 @@ namespace small
                     break;
 
                 // decode it
-                int add = get_indexof_base64char( ch );
+                int add = alphabet_index<_Alphabet>::table.index[(unsigned char)ch];
                 if ( add < 0 )
                     continue;
 
-                decoded_word = decoded_word << 6 | add;
+                decoded_word = (decoded_word << 6 | add) & 0xFFFF;
                 count_bits += 6;
 
                 if ( count_bits >= 8 )
@@ -166,6 +229,152 @@ namespace small
 
             return decoded_length;
         }
+
+
+        // decoder state kept between calls when decoding in chunks
+        struct decode_state
+        {
+            unsigned int    decoded_word    = 0;
+            int             count_bits      = 0;
+            int             group           = 0;        // valid chars in the current group of 4
+            int             padding         = 0;        // '=' still expected after the first one
+            bool            finished        = false;    // '=' was found
+        };
+
+        // decode a chunk from base 64 with validation mode continuing from state (returns length decoded, up to the error if there is one)
+        // error_position is set to the offset in this chunk of the first rejected char or to npos when there is no error
+        // decoded_buffer can be base64 itself (in place), the write cursor never passes the read cursor and each simd
+        // block is loaded before its shorter output is stored
+        template<typename _Variant = standard>
+        inline size_t   frombase64_update           ( decode_state& state, char* decoded_buffer, const char* base64, const size_t& base64_length, EnumBase64Mode mode, size_t* error_position )
+        {
+            using alphabet = typename _Variant::alphabet;
+            const signed char* index_of = alphabet_index<alphabet>::table.index;
+
+            // local copy of the state (chars written may alias it)
+            decode_state    st = state;
+            size_t          decoded_length = 0;
+            size_t          error = npos;
+            bool            simd_blocked = false;   // simd stopped at an invalid char that was not passed yet
+
+            size_t i = 0;
+            while ( i < base64_length )
+            {
+                // after '=' only padding and whitespace (lenient) are allowed
+                if ( st.finished )
+                {
+                    if ( mode == EnumBase64Mode::kBase64_SkipInvalid )
+                        break;
+                    if ( base64[i] == '=' && st.padding > 0 )
+                        --st.padding;
+                    else if ( !(mode == EnumBase64Mode::kBase64_Lenient && is_base64_space( base64[i] )) )
+                    {
+                        error = i;
+                        break;
+                    }
+                    ++i;
+                    continue;
+                }
+
+                // whole groups with simd
+                if ( st.group == 0 && !simd_blocked )
+                {
+                    size_t done = frombase64_simd<alphabet>( decoded_buffer + decoded_length, base64 + i, base64_length - i );
+                    decoded_length += done / 4 * 3;
+                    i += done;
+                    simd_blocked = true;
+                    if ( i >= base64_length )
+                        break;
+                }
+
+                // valid chars
+                int add = -1;
+                while ( i < base64_length && (add = index_of[(unsigned char)base64[i]]) >= 0 )
+                {
+                    st.decoded_word = (st.decoded_word << 6 | add) & 0xFFFF;
+                    st.count_bits += 6;
+                    if ( st.count_bits >= 8 )
+                    {
+                        st.count_bits -= 8;
+                        decoded_buffer[decoded_length++] = (char)(unsigned char)(0xFF & (st.decoded_word >> (st.count_bits)));
+                    }
+                    st.group = (st.group + 1) & 3;
+                    ++i;
+                }
+                if ( i >= base64_length )
+                    break;
+
+                // invalid char
+                const char ch = base64[i];
+                if ( ch == '=' )
+                {
+                    // padding completes a group of 2 or 3 chars (not allowed without padding)
+                    if ( mode != EnumBase64Mode::kBase64_SkipInvalid && (st.group < 2 || !_Variant::padding) )
+                    {
+                        error = i;
+                        break;
+                    }
+                    st.finished  = true;
+                    st.padding   = st.group >= 2 ? 3 - st.group : 0;
+                    st.group     = 0;
+                    ++i;
+                    continue;
+                }
+
+                if ( mode == EnumBase64Mode::kBase64_Strict || (mode == EnumBase64Mode::kBase64_Lenient && !is_base64_space( ch )) )
+                {
+                    error = i;
+                    break;
+                }
+                // skipped (simd can be tried again at the next group)
+                simd_blocked = false;
+                ++i;
+            }
+
+            state = st;
+            if ( error_position )
+                *error_position = error;
+            return decoded_length;
+        }
+
+        // check the end of the data (false when it ends in the middle of a group or of the padding,
+        // when a padded variant ends without padding or when the unused bits of the last char are not 0)
+        template<typename _Variant = standard>
+        inline bool     frombase64_final            ( const decode_state& state, EnumBase64Mode mode )
+        {
+            if ( mode == EnumBase64Mode::kBase64_SkipInvalid )
+                return true;
+            if ( state.group == 1 || state.padding != 0 )
+                return false;
+            if ( _Variant::padding && state.group != 0 )
+                return false;
+            return (state.decoded_word & ((1u << state.count_bits) - 1)) == 0;
+        }
+
+
+        // decode from base 64 with validation mode (returns length decoded, up to the error if there is one)
+        // error_position is set to the offset of the first rejected char, or to the length when the data
+        // ends in the middle of a group, or to npos when there is no error (wrapped lines need kBase64_Lenient)
+        template<typename _Variant = standard>
+        inline size_t   frombase64                  ( char* decoded_buffer, const char* base64, const size_t& base64_length, EnumBase64Mode mode, size_t* error_position )
+        {
+            decode_state state;
+            size_t error = npos;
+            size_t decoded_length = frombase64_update<_Variant>( state, decoded_buffer, base64, base64_length, mode, &error );
+            if ( error == npos && !frombase64_final<_Variant>( state, mode ) )
+                error = base64_length;
+
+            if ( error_position )
+                *error_position = error;
+            return decoded_length;
+        }
+
+        // decode from base 64 skipping invalid chars (returns length)
+        template<typename _Variant = standard>
+        inline size_t   frombase64                  ( char* decoded_buffer, const char* base64, const size_t& base64_length )
+        {
+            return frombase64<_Variant>( decoded_buffer, base64, base64_length, EnumBase64Mode::kBase64_SkipInvalid, nullptr );
+        }
     }
     
 }
\ No newline at end of file
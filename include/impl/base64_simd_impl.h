@@ -0,0 +1,377 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu_impl.h"
+#include "base64_alphabet_impl.h"
+
+//
+// vectorized base64 kernels (specialized for each alphabet at compile time)
+// each kernel processes only whole blocks and returns how many input bytes were consumed
+// (a multiple of 3 when encoding, of 4 when decoding), the rest is done by the scalar code
+//
+// ordered alphabets (A-Z a-z 0-9 and 2 other chars) use all the kernels,
+// custom alphabets use only the avx-512 ones (table lookups)
+//
+namespace small
+{
+    namespace base64
+    {
+#if defined(SMALL_SIMD_X86)
+        //
+        // encode
+        //
+
+        // 16 bytes with 12 source bytes at offset 0 -> 16 x 6 bit indexes (one per byte)
+        SMALL_TARGET("ssse3")
+        inline __m128i  enc_reshuffle_ssse3         ( __m128i in )
+        {
+            // (b1 b0 b2 b1) for each 3 bytes
+            in = _mm_shuffle_epi8( in, _mm_set_epi8( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1 ) );
+            const __m128i t0 = _mm_and_si128( in, _mm_set1_epi32( 0x0fc0fc00 ) );
+            const __m128i t1 = _mm_mulhi_epu16( t0, _mm_set1_epi32( 0x04000040 ) );
+            const __m128i t2 = _mm_and_si128( in, _mm_set1_epi32( 0x003f03f0 ) );
+            const __m128i t3 = _mm_mullo_epi16( t2, _mm_set1_epi32( 0x01000010 ) );
+            return _mm_or_si128( t1, t3 );
+        }
+
+        // 6 bit indexes -> base64 chars
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline __m128i  enc_translate_ssse3         ( __m128i indexes )
+        {
+            // 0 for [0..25] -> 13, [26..51] -> 0, [52..61] -> 1..10, 62 -> 11, 63 -> 12
+            __m128i reduced = _mm_subs_epu8( indexes, _mm_set1_epi8( 51 ) );
+            const __m128i less = _mm_cmpgt_epi8( _mm_set1_epi8( 26 ), indexes );
+            reduced = _mm_or_si128( reduced, _mm_and_si128( less, _mm_set1_epi8( 13 ) ) );
+
+            const __m128i shift = _mm_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, (char)(_Alphabet::c62 - 62), (char)(_Alphabet::c63 - 63), 'A', 0, 0 );
+            return _mm_add_epi8( _mm_shuffle_epi8( shift, reduced ), indexes );
+        }
+
+        // encode blocks of 12 bytes (reads 16)
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline size_t   tobase64_ssse3              ( char* base64, const char* src, size_t src_length )
+        {
+            size_t done = 0;
+            while ( src_length - done >= 16 )
+            {
+                __m128i in = _mm_loadu_si128( (const __m128i*)(src + done) );
+                _mm_storeu_si128( (__m128i*)base64, enc_translate_ssse3<_Alphabet>( enc_reshuffle_ssse3( in ) ) );
+                base64  += 16;
+                done    += 12;
+            }
+            return done;
+        }
+
+
+        // encode blocks of 24 bytes (reads 28)
+        template<typename _Alphabet>
+        SMALL_TARGET("avx2")
+        inline size_t   tobase64_avx2               ( char* base64, const char* src, size_t src_length )
+        {
+            const __m256i shuffle   = _mm256_set_epi8( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                       10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1 );
+            const __m256i mask0     = _mm256_set1_epi32( 0x0fc0fc00 );
+            const __m256i mul0      = _mm256_set1_epi32( 0x04000040 );
+            const __m256i mask1     = _mm256_set1_epi32( 0x003f03f0 );
+            const __m256i mul1      = _mm256_set1_epi32( 0x01000010 );
+            const char    s62       = (char)(_Alphabet::c62 - 62);
+            const char    s63       = (char)(_Alphabet::c63 - 63);
+            const __m256i shift     = _mm256_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                        '0' - 52, '0' - 52, '0' - 52, s62, s63, 'A', 0, 0,
+                                                        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                        '0' - 52, '0' - 52, '0' - 52, s62, s63, 'A', 0, 0 );
+
+            size_t done = 0;
+            while ( src_length - done >= 28 )
+            {
+                // 12 bytes in each lane
+                __m128i lo  = _mm_loadu_si128( (const __m128i*)(src + done) );
+                __m128i hi  = _mm_loadu_si128( (const __m128i*)(src + done + 12) );
+                __m256i in  = _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+
+                in = _mm256_shuffle_epi8( in, shuffle );
+                const __m256i t1 = _mm256_mulhi_epu16( _mm256_and_si256( in, mask0 ), mul0 );
+                const __m256i t3 = _mm256_mullo_epi16( _mm256_and_si256( in, mask1 ), mul1 );
+                const __m256i indexes = _mm256_or_si256( t1, t3 );
+
+                __m256i reduced = _mm256_subs_epu8( indexes, _mm256_set1_epi8( 51 ) );
+                const __m256i less = _mm256_cmpgt_epi8( _mm256_set1_epi8( 26 ), indexes );
+                reduced = _mm256_or_si256( reduced, _mm256_and_si256( less, _mm256_set1_epi8( 13 ) ) );
+
+                _mm256_storeu_si256( (__m256i*)base64, _mm256_add_epi8( _mm256_shuffle_epi8( shift, reduced ), indexes ) );
+                base64  += 32;
+                done    += 24;
+            }
+            return done;
+        }
+
+
+        // encode blocks of 48 bytes (masked load, reads only 48)
+        template<typename _Alphabet>
+        SMALL_TARGET("avx512f,avx512bw,avx512vbmi")
+        inline size_t   tobase64_avx512             ( char* base64, const char* src, size_t src_length )
+        {
+            const __m512i lookup    = _mm512_loadu_si512( (const void*)_Alphabet::chars );
+            // (b1 b0 b2 b1) for each 3 bytes
+            const __m512i shuffle   = _mm512_setr_epi32( 0x01020001, 0x04050304, 0x07080607, 0x0a0b090a, 0x0d0e0c0d, 0x10110f10, 0x13141213, 0x16171516,
+                                                         0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122, 0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e );
+            // bit offsets of the 4 x 6 bit fields in each 32 bit group
+            const __m512i shifts    = _mm512_set1_epi64( 0x3036242a1016040aULL );
+            // (the maskz forms avoid gcc warnings about the undefined pass through of the unmasked ones)
+            const __mmask64 all     = (__mmask64)-1;
+
+            size_t done = 0;
+            while ( src_length - done >= 48 )
+            {
+                __m512i in      = _mm512_maskz_loadu_epi8( (__mmask64)0x0000ffffffffffffULL, (const void*)(src + done) );
+                in              = _mm512_maskz_permutexvar_epi8( all, shuffle, in );
+                __m512i indexes = _mm512_maskz_multishift_epi64_epi8( all, shifts, in );
+                _mm512_storeu_si512( (void*)base64, _mm512_maskz_permutexvar_epi8( all, indexes, lookup ) );
+                base64  += 64;
+                done    += 48;
+            }
+            return done;
+        }
+
+
+
+
+        //
+        // decode
+        //
+
+        // base64 chars -> 6 bit values, returns false if any char is not in the alphabet ('=' included)
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline bool     dec_translate_ssse3         ( __m128i& in )
+        {
+            if constexpr ( _Alphabet::c62 == '+' && _Alphabet::c63 == '/' )
+            {
+                // standard alphabet, classes by low and high nibble
+                const __m128i lut_lo    = _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a );
+                const __m128i lut_hi    = _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+                const __m128i lut_roll  = _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+                const __m128i mask_2f   = _mm_set1_epi8( 0x2f );
+
+                const __m128i hi_nibbles = _mm_and_si128( _mm_srli_epi32( in, 4 ), mask_2f );
+                const __m128i lo_nibbles = _mm_and_si128( in, mask_2f );
+                const __m128i hi = _mm_shuffle_epi8( lut_hi, hi_nibbles );
+                const __m128i lo = _mm_shuffle_epi8( lut_lo, lo_nibbles );
+                // a char is valid when its classes by low and high nibble do not intersect
+                if ( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( lo, hi ), _mm_setzero_si128() ) ) != 0xffff )
+                    return false;
+
+                const __m128i eq_2f = _mm_cmpeq_epi8( in, mask_2f );
+                in = _mm_add_epi8( in, _mm_shuffle_epi8( lut_roll, _mm_add_epi8( eq_2f, hi_nibbles ) ) );
+                return true;
+            }
+            else
+            {
+                // other ordered alphabets, ranges (unsigned x <= max is min(x, max) == x)
+                const __m128i up    = _mm_sub_epi8( in, _mm_set1_epi8( 'A' ) );
+                const __m128i low   = _mm_sub_epi8( in, _mm_set1_epi8( 'a' ) );
+                const __m128i dig   = _mm_sub_epi8( in, _mm_set1_epi8( '0' ) );
+                const __m128i is_up = _mm_cmpeq_epi8( _mm_min_epu8( up,  _mm_set1_epi8( 25 ) ), up  );
+                const __m128i is_low= _mm_cmpeq_epi8( _mm_min_epu8( low, _mm_set1_epi8( 25 ) ), low );
+                const __m128i is_dig= _mm_cmpeq_epi8( _mm_min_epu8( dig, _mm_set1_epi8( 9 ) ),  dig );
+                const __m128i is_62 = _mm_cmpeq_epi8( in, _mm_set1_epi8( _Alphabet::c62 ) );
+                const __m128i is_63 = _mm_cmpeq_epi8( in, _mm_set1_epi8( _Alphabet::c63 ) );
+
+                const __m128i valid = _mm_or_si128( _mm_or_si128( _mm_or_si128( is_up, is_low ), _mm_or_si128( is_dig, is_62 ) ), is_63 );
+                if ( _mm_movemask_epi8( valid ) != 0xffff )
+                    return false;
+
+                __m128i v = _mm_and_si128( is_up, up );
+                v = _mm_or_si128( v, _mm_and_si128( is_low, _mm_add_epi8( low, _mm_set1_epi8( 26 ) ) ) );
+                v = _mm_or_si128( v, _mm_and_si128( is_dig, _mm_add_epi8( dig, _mm_set1_epi8( 52 ) ) ) );
+                v = _mm_or_si128( v, _mm_and_si128( is_62, _mm_set1_epi8( 62 ) ) );
+                v = _mm_or_si128( v, _mm_and_si128( is_63, _mm_set1_epi8( 63 ) ) );
+                in = v;
+                return true;
+            }
+        }
+
+        // decode blocks of 16 chars -> 12 bytes
+        template<typename _Alphabet>
+        SMALL_TARGET("ssse3")
+        inline size_t   frombase64_ssse3            ( char* decoded, const char* base64, size_t base64_length )
+        {
+            size_t done = 0;
+            while ( base64_length - done >= 16 )
+            {
+                __m128i in = _mm_loadu_si128( (const __m128i*)(base64 + done) );
+                if ( !dec_translate_ssse3<_Alphabet>( in ) )
+                    break;
+
+                // pack 4 x 6 bits -> 3 bytes
+                const __m128i ab_bc = _mm_maddubs_epi16( in, _mm_set1_epi32( 0x01400140 ) );
+                __m128i out = _mm_madd_epi16( ab_bc, _mm_set1_epi32( 0x00011000 ) );
+                out = _mm_shuffle_epi8( out, _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+
+                _mm_storel_epi64( (__m128i*)decoded, out );
+                int last = _mm_cvtsi128_si32( _mm_srli_si128( out, 8 ) );
+                memcpy( decoded + 8, &last, 4 );
+                decoded += 12;
+                done    += 16;
+            }
+            return done;
+        }
+
+
+        // base64 chars -> 6 bit values, returns false if any char is not in the alphabet ('=' included)
+        template<typename _Alphabet>
+        SMALL_TARGET("avx2")
+        inline bool     dec_translate_avx2          ( __m256i& in )
+        {
+            if constexpr ( _Alphabet::c62 == '+' && _Alphabet::c63 == '/' )
+            {
+                // standard alphabet, classes by low and high nibble
+                const __m256i lut_lo    = _mm256_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                                            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a );
+                const __m256i lut_hi    = _mm256_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+                const __m256i lut_roll  = _mm256_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+                const __m256i mask_2f   = _mm256_set1_epi8( 0x2f );
+
+                const __m256i hi_nibbles = _mm256_and_si256( _mm256_srli_epi32( in, 4 ), mask_2f );
+                const __m256i lo_nibbles = _mm256_and_si256( in, mask_2f );
+                const __m256i hi = _mm256_shuffle_epi8( lut_hi, hi_nibbles );
+                const __m256i lo = _mm256_shuffle_epi8( lut_lo, lo_nibbles );
+                if ( !_mm256_testz_si256( lo, hi ) )
+                    return false;
+
+                const __m256i eq_2f = _mm256_cmpeq_epi8( in, mask_2f );
+                in = _mm256_add_epi8( in, _mm256_shuffle_epi8( lut_roll, _mm256_add_epi8( eq_2f, hi_nibbles ) ) );
+                return true;
+            }
+            else
+            {
+                // other ordered alphabets, ranges (unsigned x <= max is min(x, max) == x)
+                const __m256i up    = _mm256_sub_epi8( in, _mm256_set1_epi8( 'A' ) );
+                const __m256i low   = _mm256_sub_epi8( in, _mm256_set1_epi8( 'a' ) );
+                const __m256i dig   = _mm256_sub_epi8( in, _mm256_set1_epi8( '0' ) );
+                const __m256i is_up = _mm256_cmpeq_epi8( _mm256_min_epu8( up,  _mm256_set1_epi8( 25 ) ), up  );
+                const __m256i is_low= _mm256_cmpeq_epi8( _mm256_min_epu8( low, _mm256_set1_epi8( 25 ) ), low );
+                const __m256i is_dig= _mm256_cmpeq_epi8( _mm256_min_epu8( dig, _mm256_set1_epi8( 9 ) ),  dig );
+                const __m256i is_62 = _mm256_cmpeq_epi8( in, _mm256_set1_epi8( _Alphabet::c62 ) );
+                const __m256i is_63 = _mm256_cmpeq_epi8( in, _mm256_set1_epi8( _Alphabet::c63 ) );
+
+                const __m256i valid = _mm256_or_si256( _mm256_or_si256( _mm256_or_si256( is_up, is_low ), _mm256_or_si256( is_dig, is_62 ) ), is_63 );
+                if ( (unsigned int)_mm256_movemask_epi8( valid ) != 0xffffffffu )
+                    return false;
+
+                __m256i v = _mm256_and_si256( is_up, up );
+                v = _mm256_or_si256( v, _mm256_and_si256( is_low, _mm256_add_epi8( low, _mm256_set1_epi8( 26 ) ) ) );
+                v = _mm256_or_si256( v, _mm256_and_si256( is_dig, _mm256_add_epi8( dig, _mm256_set1_epi8( 52 ) ) ) );
+                v = _mm256_or_si256( v, _mm256_and_si256( is_62, _mm256_set1_epi8( 62 ) ) );
+                v = _mm256_or_si256( v, _mm256_and_si256( is_63, _mm256_set1_epi8( 63 ) ) );
+                in = v;
+                return true;
+            }
+        }
+
+        // decode blocks of 32 chars -> 24 bytes
+        template<typename _Alphabet>
+        SMALL_TARGET("avx2")
+        inline size_t   frombase64_avx2             ( char* decoded, const char* base64, size_t base64_length )
+        {
+            const __m256i pack      = _mm256_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+
+            size_t done = 0;
+            while ( base64_length - done >= 32 )
+            {
+                __m256i in = _mm256_loadu_si256( (const __m256i*)(base64 + done) );
+                if ( !dec_translate_avx2<_Alphabet>( in ) )
+                    break;
+
+                const __m256i ab_bc = _mm256_maddubs_epi16( in, _mm256_set1_epi32( 0x01400140 ) );
+                __m256i out = _mm256_madd_epi16( ab_bc, _mm256_set1_epi32( 0x00011000 ) );
+                out = _mm256_shuffle_epi8( out, pack );
+                out = _mm256_permutevar8x32_epi32( out, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 ) );
+
+                _mm_storeu_si128( (__m128i*)decoded, _mm256_castsi256_si128( out ) );
+                _mm_storel_epi64( (__m128i*)(decoded + 16), _mm256_extracti128_si256( out, 1 ) );
+                decoded += 24;
+                done    += 32;
+            }
+            return done;
+        }
+
+
+        // decode blocks of 64 chars -> 48 bytes
+        template<typename _Alphabet>
+        SMALL_TARGET("avx512f,avx512bw,avx512vbmi")
+        inline size_t   frombase64_avx512           ( char* decoded, const char* base64, size_t base64_length )
+        {
+            // ascii -> 6 bit value, 0x80 when not in the alphabet
+            const unsigned char* lookup = alphabet_index<_Alphabet>::table.lookup;
+            const __m512i lookup_lo = _mm512_loadu_si512( (const void*)lookup );
+            const __m512i lookup_hi = _mm512_loadu_si512( (const void*)(lookup + 64) );
+            // 3 bytes from each 32 bit group
+            const __m512i pack      = _mm512_setr_epi32( 0x06000102, 0x090a0405, 0x0c0d0e08, 0x16101112, 0x191a1415, 0x1c1d1e18, 0x26202122, 0x292a2425,
+                                                         0x2c2d2e28, 0x36303132, 0x393a3435, 0x3c3d3e38, 0, 0, 0, 0 );
+            const __mmask64 all     = (__mmask64)-1;
+
+            size_t done = 0;
+            while ( base64_length - done >= 64 )
+            {
+                const __m512i in = _mm512_loadu_si512( (const void*)(base64 + done) );
+                const __m512i translated = _mm512_permutex2var_epi8( lookup_lo, in, lookup_hi );
+                // high bit set for chars >= 0x80 or not in the alphabet
+                if ( _mm512_movepi8_mask( _mm512_or_si512( translated, in ) ) != 0 )
+                    break;
+
+                const __m512i ab_bc = _mm512_maddubs_epi16( translated, _mm512_set1_epi32( 0x01400140 ) );
+                const __m512i out = _mm512_maskz_permutexvar_epi8( all, pack, _mm512_madd_epi16( ab_bc, _mm512_set1_epi32( 0x00011000 ) ) );
+                _mm512_mask_storeu_epi8( (void*)decoded, (__mmask64)0x0000ffffffffffffULL, out );
+                decoded += 48;
+                done    += 64;
+            }
+            return done;
+        }
+#endif // SMALL_SIMD_X86
+
+
+        // encode whole blocks with the best kernel available (returns source bytes consumed)
+        template<typename _Alphabet = alphabet_standard>
+        inline size_t   tobase64_simd               ( char* base64, const char* src, size_t src_length )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:  return tobase64_avx512<_Alphabet>( base64, src, src_length );
+            case cpu::EnumSimdLevel::kSimd_AVX2:    if constexpr ( _Alphabet::ordered ) { return tobase64_avx2 <_Alphabet>( base64, src, src_length ); } break;
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   if constexpr ( _Alphabet::ordered ) { return tobase64_ssse3<_Alphabet>( base64, src, src_length ); } break;
+            default: break;
+            }
+#endif
+            (void)base64; (void)src; (void)src_length;
+            return 0;
+        }
+
+        // decode whole blocks of valid chars with the best kernel available (returns base64 chars consumed,
+        // always a multiple of 4, it stops at the first block with a char outside the alphabet, '=' included)
+        template<typename _Alphabet = alphabet_standard>
+        inline size_t   frombase64_simd             ( char* decoded, const char* base64, size_t base64_length )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:  return frombase64_avx512<_Alphabet>( decoded, base64, base64_length );
+            case cpu::EnumSimdLevel::kSimd_AVX2:    if constexpr ( _Alphabet::ordered ) { return frombase64_avx2 <_Alphabet>( decoded, base64, base64_length ); } break;
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   if constexpr ( _Alphabet::ordered ) { return frombase64_ssse3<_Alphabet>( decoded, base64, base64_length ); } break;
+            default: break;
+            }
+#endif
+            (void)decoded; (void)base64; (void)base64_length;
+            return 0;
+        }
+    }
+}
@@ -12,6 +12,8 @@
 #include <string_view>
 #include <vector>
 
+#include "../buffer_view.h"
+
 
 namespace small
 {
@@ -41,6 +43,12 @@ namespace small
         inline void     resize                      ( size_t new_size ) { this->resize_impl ( new_size );  }
         inline void     shrink_to_fit               ()                  { this->shrink_impl();             }
 
+        // direct write functions
+        // get room for at least n chars after size() (nullptr if it cannot be obtained), write into it then commit
+        inline char*    prepare                     ( size_t n )        { return this->prepare_impl( n );   }
+        // add n chars written in the room given by prepare
+        inline void     commit                      ( size_t n )        { this->commit_impl( n );           }
+
         
         // data access to buffer
         inline const char* get_buffer               () const    { return buffer_data_; }
@@ -55,6 +63,11 @@ namespace small
         inline std::vector<char>c_vector            () const    { std::vector<char> v; v.reserve( size() + 1 ); v.resize( size() ); memcpy( v.data(), data(), size() ); return v; }
         inline std::string_view c_view              () const    { return std::string_view{ data(), size() }; }
 
+        // non owning views (no copy, valid until the buffer changes)
+        inline buffer_view      view                () const    { return buffer_view{ data(), size() }; }
+        inline buffer_view      slice               ( size_t from, size_t len = buffer_view::npos ) const { return view().substr( from, len ); }
+        inline buffer_view      substr              ( size_t from, size_t len = buffer_view::npos ) const { return slice( from, len ); }
+
 
         // assign
         inline void     assign                      ( const base_buffer& b      )   { if ( this != &b ) { set( 0/*startfrom*/, b.data(), b.size() ); } }
@@ -159,6 +172,19 @@ namespace small
             return (cmp != 0) ? /*different*/cmp : /*equal so far*/(size() == s_length ? 0/*true equal*/ : (size() < s_length ? -1 : 1));
         }
 
+        // search
+        inline size_t   find                        ( const char  c,                size_t from = 0 ) const { return view().find( c, from ); }
+        inline size_t   find                        ( const char* s,                size_t from = 0 ) const { return view().find( s, from ); }
+        inline size_t   find                        ( const char* s, size_t len,    size_t from     ) const { return view().find( s, len, from ); }
+        inline size_t   find                        ( const std::string_view s,     size_t from = 0 ) const { return view().find( s, from ); }
+
+        inline size_t   rfind                       ( const char  c,                size_t from = buffer_view::npos ) const { return view().rfind( c, from ); }
+        inline size_t   rfind                       ( const char* s,                size_t from = buffer_view::npos ) const { return view().rfind( s, from ); }
+        inline size_t   rfind                       ( const std::string_view s,     size_t from = buffer_view::npos ) const { return view().rfind( s, from ); }
+
+        inline bool     starts_with                 ( const std::string_view s ) const { return view().starts_with( s ); }
+        inline bool     ends_with                   ( const std::string_view s ) const { return view().ends_with( s );   }
+
         // TODO
         inline bool     is_equal                    ( const wchar_t *s, size_t s_length ) const { return size() == s_length && compare( s, s_length ) == 0; }
         inline int      compare                     ( const wchar_t *s, size_t s_length ) const { return memcmp( data(), s, size() < s_length ? size()+1 : s_length+1 ); }
@@ -242,6 +268,9 @@ namespace small
         virtual void    reserve_impl    ( size_t/*size*/ ) = 0;
         virtual void    resize_impl     ( size_t/*size*/ ) = 0;
         virtual void    shrink_impl     () = 0;
+
+        virtual char*   prepare_impl    ( size_t/*n*/ ) = 0;
+        virtual void    commit_impl     ( size_t/*n*/ ) = 0;
         
         virtual void    set_impl        ( size_t from, const char*    buffer, size_t length ) { buffer_set_impl( from, buffer, length ); }
         virtual void    set_impl        ( size_t from, const wchar_t* buffer, size_t length ) { buffer_set_impl( from, (const char*)buffer, sizeof( wchar_t ) * length ); }
@@ -354,8 +383,15 @@ namespace small
     inline bool         operator==                  ( const std::vector<wchar_t>&v,const base_buffer& b){ return b.is_equal( v.data(),  v.size()    ); }
 
 
+    // == view
+    inline bool         operator==                  ( const base_buffer& b, const buffer_view& v      ) { return b.is_equal( v.data(),   v.size()   ); }
+    inline bool         operator==                  ( const buffer_view& v, const base_buffer& b      ) { return b.is_equal( v.data(),   v.size()   ); }
+
+
     // !=
     inline bool         operator!=                  ( const base_buffer& b, const base_buffer& b2     ) { return !b.is_equal( b2.data(),b2.size()   ); }
+    inline bool         operator!=                  ( const base_buffer& b, const buffer_view& v      ) { return !b.is_equal( v.data(), v.size()    ); }
+    inline bool         operator!=                  ( const buffer_view& v, const base_buffer& b      ) { return !b.is_equal( v.data(), v.size()    ); }
 
     inline bool         operator!=                  ( const base_buffer& b, const char    c           ) { return !b.is_equal( &c,       1           ); }
     inline bool         operator!=                  ( const base_buffer& b, const char*   s           ) { return !b.is_equal( s,        strlen(s)   ); }
@@ -385,6 +421,8 @@ namespace small
 
      // < 
     inline bool         operator<                   ( const base_buffer& b, const base_buffer& b2       ) { return b.compare( b2.data(),b2.size()   ) < 0; }
+    inline bool         operator<                   ( const base_buffer& b, const buffer_view& v        ) { return b.compare( v.data(), v.size()    ) < 0; }
+    inline bool         operator<                   ( const buffer_view& v, const base_buffer& b        ) { return b.compare( v.data(), v.size()    ) > 0; }
 
     inline bool         operator<                   ( const base_buffer& b, const char c                ) { return b.compare( &c,       1           ) < 0; }
     inline bool         operator<                   ( const base_buffer& b, const char* s               ) { return b.compare( s,        strlen( s ) ) < 0; }
@@ -414,6 +452,8 @@ namespace small
 
     // <= 
     inline bool         operator<=                  ( const base_buffer& b, const base_buffer& b2       ) { return b.compare( b2.data(),b2.size()   ) <= 0; }
+    inline bool         operator<=                  ( const base_buffer& b, const buffer_view& v        ) { return b.compare( v.data(), v.size()    ) <= 0; }
+    inline bool         operator<=                  ( const buffer_view& v, const base_buffer& b        ) { return b.compare( v.data(), v.size()    ) >= 0; }
 
     inline bool         operator<=                  ( const base_buffer& b, const char c                ) { return b.compare( &c,       1           ) <= 0; }
     inline bool         operator<=                  ( const base_buffer& b, const char* s               ) { return b.compare( s,        strlen( s ) ) <= 0; }
@@ -443,6 +483,8 @@ namespace small
 
     // >
     inline bool         operator>                   ( const base_buffer& b, const base_buffer& b2       ) { return b.compare( b2.data(),b2.size()   ) > 0; }
+    inline bool         operator>                   ( const base_buffer& b, const buffer_view& v        ) { return b.compare( v.data(), v.size()    ) > 0; }
+    inline bool         operator>                   ( const buffer_view& v, const base_buffer& b        ) { return b.compare( v.data(), v.size()    ) < 0; }
 
     inline bool         operator>                   ( const base_buffer& b, const char c                ) { return b.compare( &c,       1           ) > 0; }
     inline bool         operator>                   ( const base_buffer& b, const char* s               ) { return b.compare( s,        strlen( s ) ) > 0; }
@@ -473,6 +515,8 @@ namespace small
 
     // >= 
     inline bool         operator>=                  ( const base_buffer& b, const base_buffer& b2       ) { return b.compare( b2.data(),b2.size()   ) >= 0; }
+    inline bool         operator>=                  ( const base_buffer& b, const buffer_view& v        ) { return b.compare( v.data(), v.size()    ) >= 0; }
+    inline bool         operator>=                  ( const buffer_view& v, const base_buffer& b        ) { return b.compare( v.data(), v.size()    ) <= 0; }
 
     inline bool         operator>=                  ( const base_buffer& b, const char c                ) { return b.compare( &c,       1           ) >= 0; }
     inline bool         operator>=                  ( const base_buffer& b, const char* s               ) { return b.compare( s,        strlen( s ) ) >= 0; }
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <string_view>
+
+#include "case_impl.h"
+
+//
+// case tables, case insensitive compare and case folding (included by util.h)
+//
+namespace small
+{
+    // to lower
+    const unsigned char to_lower[] = 
+    {
+               0,         1,        2,        3,        4,       5,         6,        7,        8,        9,       10,       11,
+              12,        13,       14,       15,       16,      17,        18,       19,       20,       21,       22,       23,
+              24,        25,       26,       27,       28,      29,        30,       31,  /* */32,  /*!*/33, /*\"*/34,  /*#*/35,
+         /*$*/36,   /*%*/37,  /*&*/38, /*\'*/39,  /*(*/40,  /*)*/41,  /***/42,  /*+*/43,  /*,*/44,  /*-*/45,  /*.*/46,  /*/*/47,
+         /*0*/48,   /*1*/49,  /*2*/50,  /*3*/51,  /*4*/52,  /*5*/53,  /*6*/54,  /*7*/55,  /*8*/56,  /*9*/57,  /*:*/58,  /*;*/59,
+         /*<*/60,   /*=*/61,  /*>*/62,  /*?*/63,  /*@*/64, /*A*/'a', /*B*/'b', /*C*/'c', /*D*/'d', /*E*/'e', /*F*/'f', /*G*/'g',
+        /*H*/'h',  /*I*/'i', /*J*/'j', /*K*/'k', /*L*/'l', /*M*/'m', /*N*/'n', /*O*/'o', /*P*/'p', /*Q*/'q', /*R*/'r', /*S*/'s',
+        /*T*/'t',  /*U*/'u', /*V*/'v', /*W*/'w', /*X*/'x', /*Y*/'y', /*Z*/'z',  /*[*/91, /*\'*/92,  /*]*/93,  /*^*/94,  /*_*/95,
+         /*`*/96,   /*a*/97,  /*b*/98,  /*c*/99, /*d*/100, /*e*/101, /*f*/102, /*g*/103, /*h*/104, /*i*/105, /*j*/106, /*k*/107,
+         /*l*/108, /*m*/109, /*n*/110, /*o*/111, /*p*/112, /*q*/113, /*r*/114, /*s*/115, /*t*/116, /*u*/117, /*v*/118, /*w*/119,
+         /*x*/120, /*y*/121, /*z*/122, /*{*/123, /*|*/124, /*}*/125, /*~*/126,  /**/127, /**/128,  /**/129, /**/130, /**/131,
+         /**/132, /**/133, /**/134, /**/135, /**/136, /**/137,/*-*/154,/**/139,/*-*/156, /**/141,/*-*/158, /**/143,
+          /**/144, /**/145, /**/146, /**/147, /**/148, /**/149, /**/150, /**/151,  /**/152, /**/153, /**/154, /**/155,
+         /**/156,  /**/157, /**/158,/*-*/255,/**/160, /**/161, /**/162, /**/163, /**/164, /**/165, /**/166, /**/167,
+         /**/168, /**/169, /**/170, /**/171, /**/172,  /**/173, /**/174, /**/175, /**/176, /**/177, /**/178, /**/179,
+         /**/180, /**/181, /**/182, /**/183, /**/184, /**/185, /**/186, /**/187, /**/188, /**/189, /**/190, /**/191,
+       /*-*/224, /**/225, /**/226, /**/227, /**/228, /**/229, /**/230, /**/231, /**/232, /**/233, /**/234,/*-*/235,
+       /*-*/236, /**/237, /**/238, /**/239, /**/240, /**/241, /**/242, /**/243, /**/244, /**/245, /**/246, /**/215,
+       /*-*/248, /**/249, /**/250, /**/251, /**/252, /**/253,/*-*/254,/**/223, /**/224, /**/225, /**/226, /**/227,
+         /**/228, /**/229, /**/230, /**/231, /**/232, /**/233, /**/234, /**/235, /**/236, /**/237, /**/238, /**/239,
+         /**/240, /**/241, /**/242, /**/243, /**/244, /**/245, /**/246, /**/247, /**/248, /**/249, /**/250, /**/251,
+         /**/252, /**/253, /**/254, /**/255
+    };
+
+    // to upper (the reverse of to_lower)
+    struct case_table
+    {
+        unsigned char   chars[256];
+    };
+
+    constexpr case_table make_to_upper_table        ()
+    {
+        case_table t = {};
+        for ( int i = 0; i < 256; ++i )
+            t.chars[i] = (unsigned char)i;
+        for ( int i = 0; i < 256; ++i )
+            if ( to_lower[i] != i )
+                t.chars[to_lower[i]] = (unsigned char)i;
+        return t;
+    }
+
+    alignas(64) inline constexpr case_table to_upper_table = make_to_upper_table();
+    inline constexpr const unsigned char* to_upper = to_upper_table.chars;
+
+
+    // what changes case, only A-Z / a-z (like stricmp) or the to_lower / to_upper tables
+    enum class EnumCaseFold
+    {
+        kFold_ASCII,
+        kFold_Latin1,
+    };
+
+
+    // stricmp with lengths (16 / 32 chars at a time), a shorter text that matches is less
+    inline int          strnicmp                    ( const char* a, size_t a_length, const char* b, size_t b_length, EnumCaseFold fold = EnumCaseFold::kFold_ASCII )
+    {
+        const unsigned char* table = fold == EnumCaseFold::kFold_Latin1 ? to_lower : nullptr;
+        size_t length = a_length < b_length ? a_length : b_length;
+        size_t i = ascii::mismatch( a, b, length, table );
+        if ( i < length )
+        {
+            int f = table ? table[(unsigned char)a[i]] : (unsigned char)ascii::lower( a[i] );
+            int l = table ? table[(unsigned char)b[i]] : (unsigned char)ascii::lower( b[i] );
+            return f - l;
+        }
+        return a_length == b_length ? 0 : (a_length < b_length ? -1 : 1);
+    }
+
+    // equal ignoring the case
+    inline bool         iequals                     ( const char* a, size_t a_length, const char* b, size_t b_length, EnumCaseFold fold = EnumCaseFold::kFold_ASCII )
+    {
+        return a_length == b_length && ascii::mismatch( a, b, a_length, fold == EnumCaseFold::kFold_Latin1 ? to_lower : nullptr ) == a_length;
+    }
+    inline bool         iequals                     ( const std::string_view a, const std::string_view b, EnumCaseFold fold = EnumCaseFold::kFold_ASCII ) { return iequals( a.data(), a.size(), b.data(), b.size(), fold ); }
+
+
+    // lower / upper case into dst (dst can be src)
+    inline void         to_lower_copy               ( char* dst, const char* src, size_t length, EnumCaseFold fold = EnumCaseFold::kFold_ASCII ) { ascii::case_copy<false>( dst, src, length, fold == EnumCaseFold::kFold_Latin1 ? to_lower : nullptr ); }
+    inline void         to_upper_copy               ( char* dst, const char* src, size_t length, EnumCaseFold fold = EnumCaseFold::kFold_ASCII ) { ascii::case_copy<true> ( dst, src, length, fold == EnumCaseFold::kFold_Latin1 ? to_upper : nullptr ); }
+
+    // lower / upper case in place
+    inline void         to_lower_inplace            ( char* s, size_t length,   EnumCaseFold fold = EnumCaseFold::kFold_ASCII ) { to_lower_copy( s, s, length, fold ); }
+    inline void         to_upper_inplace            ( char* s, size_t length,   EnumCaseFold fold = EnumCaseFold::kFold_ASCII ) { to_upper_copy( s, s, length, fold ); }
+
+    // any string or buffer with a writable data() and size() (std::string, small::buffer, small::hashed_buffer, ...)
+    // !! a read only mapped_buffer has a non const data() but its pages cannot be written
+    template<typename _String>
+    inline auto         to_lower_inplace            ( _String& s,               EnumCaseFold fold = EnumCaseFold::kFold_ASCII ) -> decltype( to_lower_copy( s.data(), s.data(), s.size(), fold ) ) { to_lower_inplace( s.data(), s.size(), fold ); }
+    template<typename _String>
+    inline auto         to_upper_inplace            ( _String& s,               EnumCaseFold fold = EnumCaseFold::kFold_ASCII ) -> decltype( to_upper_copy( s.data(), s.data(), s.size(), fold ) ) { to_upper_inplace( s.data(), s.size(), fold ); }
+}
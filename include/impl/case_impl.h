@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "case_simd_impl.h"
+
+
+namespace small
+{
+    namespace ascii
+    {
+        const unsigned long long ones = 0x0101010101010101ULL;
+
+        // lower / upper case of one char (only A-Z / a-z change)
+        inline char     lower                       ( char c ) { return (unsigned char)( c - 'A' ) < 26 ? (char)( c + ( 'a' - 'A' ) ) : c; }
+        inline char     upper                       ( char c ) { return (unsigned char)( c - 'a' ) < 26 ? (char)( c - ( 'a' - 'A' ) ) : c; }
+
+        // A-Z -> a-z (_Upper a-z -> A-Z) 8 chars at a time (bytes above 127 stay as they are)
+        // each byte is checked on its low 7 bits so the additions never carry into the next byte
+        template<bool _Upper>
+        inline unsigned long long fold_word         ( unsigned long long x )
+        {
+            const unsigned long long first  = _Upper ? 'a' : 'A';
+            unsigned long long low7     = x & ( 0x7f * ones );
+            unsigned long long above    = low7 + ( 0x7f - ( first + 25 ) ) * ones; // high bit set when > last letter
+            unsigned long long from     = low7 + ( 0x80 - first ) * ones;          // high bit set when >= first letter
+            unsigned long long letters  = ( from ^ above ) & ~x & ( 0x80 * ones );
+            return x ^ ( letters >> 2 );                                            // 0x80 >> 2 = 'a' - 'A'
+        }
+        inline unsigned long long lower_word        ( unsigned long long x ) { return fold_word<false>( x ); }
+
+
+        // scalar folding (the reference and the tail after simd)
+        template<bool _Upper>
+        inline void     case_copy_scalar            ( char* dst, const char* src, size_t length, const unsigned char* table )
+        {
+            size_t i = 0;
+            if ( table != nullptr )
+            {
+                for ( ; i < length; ++i )
+                    dst[i] = (char)table[(unsigned char)src[i]];
+                return;
+            }
+
+            for ( ; i + 8 <= length; i += 8 )
+            {
+                unsigned long long w;
+                memcpy( &w, src + i, sizeof( w ) );
+                w = fold_word<_Upper>( w );
+                memcpy( dst + i, &w, sizeof( w ) );
+            }
+            for ( ; i < length; ++i )
+                dst[i] = _Upper ? upper( src[i] ) : lower( src[i] );
+        }
+
+        // dst = src with A-Z -> a-z (_Upper a-z -> A-Z), dst can be src
+        // with a table every byte is mapped through it (the table must fold A-Z like ascii)
+        template<bool _Upper>
+        inline void     case_copy                   ( char* dst, const char* src, size_t length, const unsigned char* table = nullptr )
+        {
+            size_t done = case_copy_simd<_Upper>( dst, src, length, table );
+            case_copy_scalar<_Upper>( dst + done, src + done, length - done, table );
+        }
+
+        inline void     lower_copy                  ( char* dst, const char* src, size_t length ) { case_copy<false>( dst, src, length ); }
+
+
+        // offset of the first char that differs ignoring the case (length when equal)
+        // with a table (lower case table) chars are compared through it
+        inline size_t   mismatch                    ( const char* a, const char* b, size_t length, const unsigned char* table = nullptr )
+        {
+            size_t i = mismatch_simd( a, b, length, table );
+
+            if ( table != nullptr )
+            {
+                for ( ; i < length; ++i )
+                    if ( table[(unsigned char)a[i]] != table[(unsigned char)b[i]] )
+                        return i;
+                return length;
+            }
+
+            for ( ; i + 8 <= length; i += 8 )
+            {
+                unsigned long long wa, wb;
+                memcpy( &wa, a + i, sizeof( wa ) );
+                memcpy( &wb, b + i, sizeof( wb ) );
+                if ( wa != wb && lower_word( wa ) != lower_word( wb ) )
+                    break;
+            }
+            for ( ; i < length; ++i )
+            {
+                if ( a[i] != b[i] && lower( a[i] ) != lower( b[i] ) )
+                    return i;
+            }
+            return length;
+        }
+
+        // equal ignoring the case of A-Z
+        inline bool     equals                      ( const char* a, const char* b, size_t length ) { return mismatch( a, b, length ) == length; }
+    }
+}
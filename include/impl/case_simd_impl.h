@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu_impl.h"
+
+//
+// vectorized case folding and case insensitive compare
+// each kernel processes only whole blocks and returns how many bytes were done,
+// the rest is done by the scalar code
+//
+// a letter is found by moving its range to the bottom of the signed bytes (first letter -> -128)
+// and one signed compare, then the 0x20 bit is flipped
+// with a table (latin1) the blocks that have bytes above 127 are done through the table
+//
+namespace small
+{
+    namespace ascii
+    {
+#if defined(SMALL_SIMD_X86)
+        // A-Z -> a-z (_Upper a-z -> A-Z) in blocks of 16 chars (dst can be src)
+        template<bool _Upper>
+        SMALL_TARGET("sse2")
+        inline size_t   case_copy_sse2              ( char* dst, const char* src, size_t length, const unsigned char* table )
+        {
+            const __m128i shift = _mm_set1_epi8( (char)( 0x80 - ( _Upper ? 'a' : 'A' ) ) );
+            const __m128i limit = _mm_set1_epi8( (char)( 0x80 + 26 ) );
+            const __m128i bit   = _mm_set1_epi8( 0x20 );
+
+            size_t i = 0;
+            for ( ; i + 16 <= length; i += 16 )
+            {
+                __m128i x = _mm_loadu_si128( (const __m128i*)( src + i ) );
+                if ( table != nullptr && _mm_movemask_epi8( x ) != 0 )
+                {
+                    for ( size_t k = i; k < i + 16; ++k )
+                        dst[k] = (char)table[(unsigned char)src[k]];
+                    continue;
+                }
+                __m128i letters = _mm_cmpgt_epi8( limit, _mm_add_epi8( x, shift ) );
+                _mm_storeu_si128( (__m128i*)( dst + i ), _mm_xor_si128( x, _mm_and_si128( letters, bit ) ) );
+            }
+            return i;
+        }
+
+        // offset of the first block of 16 chars that differs ignoring the case (or the whole blocks compared)
+        SMALL_TARGET("sse2")
+        inline size_t   mismatch_sse2               ( const char* a, const char* b, size_t length, const unsigned char* table )
+        {
+            const __m128i shift = _mm_set1_epi8( (char)( 0x80 - 'A' ) );
+            const __m128i limit = _mm_set1_epi8( (char)( 0x80 + 26 ) );
+            const __m128i bit   = _mm_set1_epi8( 0x20 );
+
+            size_t i = 0;
+            for ( ; i + 16 <= length; i += 16 )
+            {
+                __m128i x = _mm_loadu_si128( (const __m128i*)( a + i ) );
+                __m128i y = _mm_loadu_si128( (const __m128i*)( b + i ) );
+                if ( table != nullptr && _mm_movemask_epi8( _mm_or_si128( x, y ) ) != 0 )
+                {
+                    for ( size_t k = i; k < i + 16; ++k )
+                        if ( table[(unsigned char)a[k]] != table[(unsigned char)b[k]] )
+                            return i;
+                    continue;
+                }
+                x = _mm_xor_si128( x, _mm_and_si128( _mm_cmpgt_epi8( limit, _mm_add_epi8( x, shift ) ), bit ) );
+                y = _mm_xor_si128( y, _mm_and_si128( _mm_cmpgt_epi8( limit, _mm_add_epi8( y, shift ) ), bit ) );
+                if ( _mm_movemask_epi8( _mm_cmpeq_epi8( x, y ) ) != 0xffff )
+                    return i;
+            }
+            return i;
+        }
+
+
+        // A-Z -> a-z (_Upper a-z -> A-Z) in blocks of 32 chars (dst can be src)
+        template<bool _Upper>
+        SMALL_TARGET("avx2")
+        inline size_t   case_copy_avx2              ( char* dst, const char* src, size_t length, const unsigned char* table )
+        {
+            const __m256i shift = _mm256_set1_epi8( (char)( 0x80 - ( _Upper ? 'a' : 'A' ) ) );
+            const __m256i limit = _mm256_set1_epi8( (char)( 0x80 + 26 ) );
+            const __m256i bit   = _mm256_set1_epi8( 0x20 );
+
+            size_t i = 0;
+            for ( ; i + 32 <= length; i += 32 )
+            {
+                __m256i x = _mm256_loadu_si256( (const __m256i*)( src + i ) );
+                if ( table != nullptr && _mm256_movemask_epi8( x ) != 0 )
+                {
+                    for ( size_t k = i; k < i + 32; ++k )
+                        dst[k] = (char)table[(unsigned char)src[k]];
+                    continue;
+                }
+                __m256i letters = _mm256_cmpgt_epi8( limit, _mm256_add_epi8( x, shift ) );
+                _mm256_storeu_si256( (__m256i*)( dst + i ), _mm256_xor_si256( x, _mm256_and_si256( letters, bit ) ) );
+            }
+            return i;
+        }
+
+        // offset of the first block of 32 chars that differs ignoring the case (or the whole blocks compared)
+        SMALL_TARGET("avx2")
+        inline size_t   mismatch_avx2               ( const char* a, const char* b, size_t length, const unsigned char* table )
+        {
+            const __m256i shift = _mm256_set1_epi8( (char)( 0x80 - 'A' ) );
+            const __m256i limit = _mm256_set1_epi8( (char)( 0x80 + 26 ) );
+            const __m256i bit   = _mm256_set1_epi8( 0x20 );
+
+            size_t i = 0;
+            for ( ; i + 32 <= length; i += 32 )
+            {
+                __m256i x = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+                __m256i y = _mm256_loadu_si256( (const __m256i*)( b + i ) );
+                if ( table != nullptr && _mm256_movemask_epi8( _mm256_or_si256( x, y ) ) != 0 )
+                {
+                    for ( size_t k = i; k < i + 32; ++k )
+                        if ( table[(unsigned char)a[k]] != table[(unsigned char)b[k]] )
+                            return i;
+                    continue;
+                }
+                x = _mm256_xor_si256( x, _mm256_and_si256( _mm256_cmpgt_epi8( limit, _mm256_add_epi8( x, shift ) ), bit ) );
+                y = _mm256_xor_si256( y, _mm256_and_si256( _mm256_cmpgt_epi8( limit, _mm256_add_epi8( y, shift ) ), bit ) );
+                if ( _mm256_movemask_epi8( _mm256_cmpeq_epi8( x, y ) ) != -1 )
+                    return i;
+            }
+            return i;
+        }
+#endif // SMALL_SIMD_X86
+
+
+        // fold whole blocks with the best kernel available
+        template<bool _Upper>
+        inline size_t   case_copy_simd              ( char* dst, const char* src, size_t length, const unsigned char* table )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:
+            case cpu::EnumSimdLevel::kSimd_AVX2:    return case_copy_avx2<_Upper>( dst, src, length, table );
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   return case_copy_sse2<_Upper>( dst, src, length, table );
+            default: break;
+            }
+#endif
+            (void)dst; (void)src; (void)length; (void)table;
+            return 0;
+        }
+
+        // compare whole blocks with the best kernel available (returns the offset of the first block that differs)
+        inline size_t   mismatch_simd               ( const char* a, const char* b, size_t length, const unsigned char* table )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:
+            case cpu::EnumSimdLevel::kSimd_AVX2:    return mismatch_avx2( a, b, length, table );
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   return mismatch_sse2( a, b, length, table );
+            default: break;
+            }
+#endif
+            (void)a; (void)b; (void)length; (void)table;
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+
+// SIMD kernels are compiled with per function target attributes (gcc / clang on x86)
+// and selected at runtime, define SMALL_DISABLE_SIMD to use only the scalar code
+#if !defined(SMALL_DISABLE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SMALL_SIMD_X86 1
+#include <immintrin.h>
+#define SMALL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SMALL_TARGET(isa)
+#endif
+
+
+namespace small
+{
+    namespace cpu
+    {
+        // simd level available (each level includes the ones before)
+        enum class EnumSimdLevel
+        {
+            kSimd_None,
+            kSimd_SSSE3,
+            kSimd_AVX2,
+            kSimd_AVX512,           // avx512f + avx512bw + avx512vbmi
+        };
+
+        // detect what the cpu supports (cpuid)
+        inline EnumSimdLevel detect_simd_level      ()
+        {
+#if defined(SMALL_SIMD_X86)
+            __builtin_cpu_init();
+            if ( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) && __builtin_cpu_supports( "avx512vbmi" ) )
+                return EnumSimdLevel::kSimd_AVX512;
+            if ( __builtin_cpu_supports( "avx2" ) )
+                return EnumSimdLevel::kSimd_AVX2;
+            if ( __builtin_cpu_supports( "ssse3" ) )
+                return EnumSimdLevel::kSimd_SSSE3;
+#endif
+            return EnumSimdLevel::kSimd_None;
+        }
+
+        // level used (detected once, can be lowered for tests or benchmarks)
+        inline std::atomic<EnumSimdLevel>& simd_level_ref()
+        {
+            static std::atomic<EnumSimdLevel> level{ detect_simd_level() };
+            return level;
+        }
+
+        // get simd level used
+        inline EnumSimdLevel get_simd_level         () { return simd_level_ref().load( std::memory_order_relaxed ); }
+
+        // set simd level used (it can not go above what the cpu supports)
+        inline void         set_simd_level          ( EnumSimdLevel level )
+        {
+            EnumSimdLevel detected = detect_simd_level();
+            simd_level_ref().store( level < detected ? level : detected, std::memory_order_relaxed );
+        }
+    }
+}
@@ -0,0 +1,522 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "cpu_impl.h"
+#include "hash_impl.h"
+
+//
+// open addressing hash table shared by flat_map and flat_set
+//
+// slots are kept in one array with a parallel array of control bytes, one per slot:
+// empty, deleted or the low 7 bits of the hash of the key in that slot
+// a lookup goes to a group of 16 slots and compares the 16 control bytes at once (sse2)
+// only the slots whose 7 bits match compare the key, groups are probed until one has an empty slot
+//
+namespace small
+{
+    namespace flat
+    {
+        // control bytes (a full slot has 0..127)
+        const signed char   ctrl_empty      = -128;
+        const signed char   ctrl_deleted    = -2;
+        const signed char   ctrl_sentinel   = -1;       // after the last slot, stops the iterators
+
+        // slots in a group (groups start at multiples of 16)
+        const size_t        group_size      = 16;
+
+        // no slot
+        const size_t        npos            = (size_t)-1;
+
+
+        // index of the lowest bit set
+        inline size_t       lowest_bit                  ( unsigned int mask )
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return (size_t)__builtin_ctz( mask );
+#else
+            size_t i = 0;
+            for ( ; ( mask & 1 ) == 0; mask >>= 1 )
+                ++i;
+            return i;
+#endif
+        }
+
+
+        // control bytes of a group, each match returns a bit for each of the 16 slots
+        // (sse2 is part of x86_64 so it is chosen at compile time, there is no dispatch on the lookup path)
+#if defined(SMALL_SIMD_X86) && defined(__SSE2__)
+        struct group
+        {
+            explicit group                          ( const signed char* ctrl ) : ctrl_( _mm_load_si128( (const __m128i*)ctrl ) ) {}
+
+            inline unsigned int match               ( signed char h2 ) const  { return (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_set1_epi8( h2 ), ctrl_ ) ); }
+            inline unsigned int match_empty         () const                  { return match( ctrl_empty ); }
+            // empty and deleted are the only values below the sentinel
+            inline unsigned int match_free          () const                  { return (unsigned int)_mm_movemask_epi8( _mm_cmpgt_epi8( _mm_set1_epi8( ctrl_sentinel ), ctrl_ ) ); }
+
+            __m128i         ctrl_;
+        };
+#else
+        struct group
+        {
+            explicit group                          ( const signed char* ctrl ) : ctrl_( ctrl ) {}
+
+            inline unsigned int match               ( signed char h2 ) const
+            {
+                unsigned int mask = 0;
+                for ( size_t i = 0; i < group_size; ++i )
+                    mask |= ( ctrl_[i] == h2 ? 1u : 0u ) << i;
+                return mask;
+            }
+            inline unsigned int match_empty         () const                  { return match( ctrl_empty ); }
+            inline unsigned int match_free          () const
+            {
+                unsigned int mask = 0;
+                for ( size_t i = 0; i < group_size; ++i )
+                    mask |= ( ctrl_[i] < ctrl_sentinel ? 1u : 0u ) << i;
+                return mask;
+            }
+
+            const signed char* ctrl_;
+        };
+#endif
+
+
+        // hash functions that declare is_avalanching are used as they are, the others are mixed first
+        // (std::hash of an integer or quick_hash keep little entropy in the low bits)
+        template<typename _Hash, typename = void>
+        struct is_avalanching : std::false_type {};
+        template<typename _Hash>
+        struct is_avalanching<_Hash, std::void_t<typename _Hash::is_avalanching>> : std::true_type {};
+
+        // transparent lookup when both the hash and the equal declare is_transparent
+        template<typename _Type, typename = void>
+        struct is_transparent : std::false_type {};
+        template<typename _Type>
+        struct is_transparent<_Type, std::void_t<typename _Type::is_transparent>> : std::true_type {};
+
+        // type of the lookup argument, any type when transparent, the key type otherwise
+        template<bool _Transparent>
+        struct key_arg_select                       { template<typename _K2, typename _Key> using type = _K2;  };
+        template<>
+        struct key_arg_select<false>                { template<typename _K2, typename _Key> using type = _Key; };
+
+
+        // slot of a map (key, value)
+        template<typename _Key, typename _Value>
+        struct map_policy
+        {
+            using key_type  = _Key;
+            using slot_type = std::pair<_Key, _Value>;
+
+            static inline const _Key&   key         ( const slot_type& slot ) { return slot.first; }
+
+            template<typename _K2, typename... _Args>
+            static inline void          construct   ( slot_type* slot, _K2&& key, _Args&&... args )
+            {
+                new ( slot ) slot_type( std::piecewise_construct, std::forward_as_tuple( std::forward<_K2>( key ) ), std::forward_as_tuple( std::forward<_Args>( args )... ) );
+            }
+        };
+
+        // slot of a set (only the key)
+        template<typename _Key>
+        struct set_policy
+        {
+            using key_type  = _Key;
+            using slot_type = _Key;
+
+            static inline const _Key&   key         ( const slot_type& slot ) { return slot; }
+
+            template<typename _K2>
+            static inline void          construct   ( slot_type* slot, _K2&& key ) { new ( slot ) slot_type( std::forward<_K2>( key ) ); }
+        };
+
+
+
+
+        // the table
+        template<typename _Policy, typename _Hash, typename _Equal>
+        class table
+        {
+        public:
+            using key_type          = typename _Policy::key_type;
+            using value_type        = typename _Policy::slot_type;
+            using hasher            = _Hash;
+            using key_equal         = _Equal;
+            using size_type         = size_t;
+
+            static constexpr bool transparent = is_transparent<_Hash>::value && is_transparent<_Equal>::value;
+
+            template<typename _K2>
+            using key_arg           = typename key_arg_select<transparent>::template type<_K2, key_type>;
+
+
+            // iterator over the full slots (the key must not be changed through it)
+            template<bool _Const>
+            class basic_iterator
+            {
+            public:
+                using value_type        = typename _Policy::slot_type;
+                using reference         = std::conditional_t<_Const, const value_type&, value_type&>;
+                using pointer           = std::conditional_t<_Const, const value_type*, value_type*>;
+                using difference_type   = ptrdiff_t;
+                using iterator_category = std::forward_iterator_tag;
+
+                basic_iterator                      () = default;
+                basic_iterator                      ( const signed char* ctrl, pointer slot ) : ctrl_( ctrl ), slot_( slot ) {}
+                // iterator -> const_iterator
+                template<bool _C = _Const, typename = std::enable_if_t<_C>>
+                basic_iterator                      ( const basic_iterator<false>& o ) : ctrl_( o.ctrl_ ), slot_( o.slot_ ) {}
+
+                inline reference        operator*   () const    { return *slot_; }
+                inline pointer          operator->  () const    { return slot_; }
+
+                inline basic_iterator&  operator++  ()          { ++ctrl_; ++slot_; skip_free(); return *this; }
+                inline basic_iterator   operator++  ( int )     { basic_iterator it = *this; ++*this; return it; }
+
+                inline bool             operator==  ( const basic_iterator& o ) const { return slot_ == o.slot_; }
+                inline bool             operator!=  ( const basic_iterator& o ) const { return slot_ != o.slot_; }
+
+            private:
+                friend class table;
+                friend class basic_iterator<true>;
+
+                // go to the next full slot (or the sentinel)
+                inline void             skip_free   ()          { while ( *ctrl_ < ctrl_sentinel ) { ++ctrl_; ++slot_; } }
+
+                const signed char*      ctrl_       = nullptr;
+                pointer                 slot_       = nullptr;
+            };
+
+            using iterator          = basic_iterator<false>;
+            using const_iterator    = basic_iterator<true>;
+
+
+        public:
+            // table (no allocation until the first insert)
+            table                                   () = default;
+            explicit table                          ( size_t count, const _Hash& hash = _Hash(), const _Equal& equal = _Equal() ) : hash_( hash ), equal_( equal ) { reserve( count ); }
+
+            table                                   ( const table& o ) : hash_( o.hash_ ), equal_( o.equal_ ) { copy_from( o ); }
+            table                                   ( table&& o ) noexcept : hash_( std::move( o.hash_ ) ), equal_( std::move( o.equal_ ) ) { steal( o ); }
+            ~table                                  () { destroy(); }
+
+            inline table&   operator=               ( const table& o )      { if ( this != &o ) { table t( o ); swap( t ); } return *this; }
+            inline table&   operator=               ( table&& o ) noexcept  { if ( this != &o ) { destroy(); hash_ = std::move( o.hash_ ); equal_ = std::move( o.equal_ ); steal( o ); } return *this; }
+
+
+            // size
+            inline size_t   size                    () const    { return size_;     }
+            inline bool     empty                   () const    { return size_ == 0; }
+            // number of slots (0 or a power of 2, at most 7/8 of them are used)
+            inline size_t   capacity                () const    { return capacity_; }
+            inline float    load_factor             () const    { return capacity_ > 0 ? (float)size_ / (float)capacity_ : 0.0f; }
+
+            inline hasher   hash_function           () const    { return hash_;  }
+            inline key_equal key_eq                 () const    { return equal_; }
+
+
+            // iterators
+            inline iterator         begin           ()          { if ( size_ == 0 ) { return end(); } iterator it( ctrl_, slots_ ); it.skip_free(); return it; }
+            inline const_iterator   begin           () const    { if ( size_ == 0 ) { return end(); } const_iterator it( ctrl_, slots_ ); it.skip_free(); return it; }
+            inline const_iterator   cbegin          () const    { return begin(); }
+            inline iterator         end             ()          { return iterator( ctrl_ + capacity_, slots_ + capacity_ ); }
+            inline const_iterator   end             () const    { return const_iterator( ctrl_ + capacity_, slots_ + capacity_ ); }
+            inline const_iterator   cend            () const    { return end(); }
+
+
+            // lookup
+            template<typename _K2 = key_type>
+            inline iterator         find            ( const key_arg<_K2>& key )         { size_t i = find_index( key, hash_of( key ) ); return i != npos ? iterator_at( i ) : end(); }
+            template<typename _K2 = key_type>
+            inline const_iterator   find            ( const key_arg<_K2>& key ) const   { size_t i = find_index( key, hash_of( key ) ); return i != npos ? const_iterator( ctrl_ + i, slots_ + i ) : end(); }
+            template<typename _K2 = key_type>
+            inline bool             contains        ( const key_arg<_K2>& key ) const   { return find_index( key, hash_of( key ) ) != npos; }
+            template<typename _K2 = key_type>
+            inline size_t           count           ( const key_arg<_K2>& key ) const   { return contains<_K2>( key ) ? 1 : 0; }
+
+
+            // erase
+            template<typename _K2 = key_type>
+            inline size_t           erase           ( const key_arg<_K2>& key )
+            {
+                size_t i = find_index( key, hash_of( key ) );
+                if ( i == npos )
+                    return 0;
+                erase_at( i );
+                return 1;
+            }
+            // returns the iterator after it
+            inline iterator         erase           ( const_iterator it )
+            {
+                size_t i = (size_t)( it.slot_ - slots_ );
+                iterator next( it.ctrl_, slots_ + i );
+                erase_at( i );
+                next.skip_free();
+                return next;
+            }
+            inline iterator         erase           ( iterator it ) { return erase( const_iterator( it ) ); }
+
+
+            // destroy all (the slots are kept)
+            inline void             clear           ()
+            {
+                if ( capacity_ == 0 )
+                    return;
+                destroy_slots();
+                reset_ctrl();
+                size_         = 0;
+                growth_left_  = max_load( capacity_ );
+            }
+
+            // room for count elements without rehash
+            inline void             reserve         ( size_t count )
+            {
+                size_t new_capacity = capacity_for( count );
+                if ( new_capacity > capacity_ )
+                    rehash( new_capacity );
+            }
+
+            inline void             swap            ( table& o ) noexcept
+            {
+                std::swap( hash_,           o.hash_         );
+                std::swap( equal_,          o.equal_        );
+                std::swap( ctrl_,           o.ctrl_         );
+                std::swap( slots_,          o.slots_        );
+                std::swap( capacity_,       o.capacity_     );
+                std::swap( size_,           o.size_         );
+                std::swap( growth_left_,    o.growth_left_  );
+            }
+
+
+        protected:
+            // insert when the key is missing (the slot is built from key and args only then)
+            template<typename _K2, typename... _Args>
+            inline std::pair<iterator, bool> emplace_key ( _K2&& key, _Args&&... args )
+            {
+                size_t h = hash_of( key );
+                size_t i = find_index( key, h );
+                if ( i != npos )
+                    return { iterator_at( i ), false };
+
+                i = find_free( h );
+                if ( i == npos || ( ctrl_[i] == ctrl_empty && growth_left_ == 0 ) )
+                {
+                    rehash_for_insert();
+                    i = find_free( h );
+                }
+
+                _Policy::construct( slots_ + i, std::forward<_K2>( key ), std::forward<_Args>( args )... );
+                if ( ctrl_[i] == ctrl_empty )
+                    --growth_left_;
+                ctrl_[i] = h2_of( h );
+                ++size_;
+                return { iterator_at( i ), true };
+            }
+
+            inline iterator         iterator_at     ( size_t i ) { return iterator( ctrl_ + i, slots_ + i ); }
+
+
+        private:
+            // hash of a key (mixed when the hash function does not avalanche)
+            template<typename _K2>
+            inline size_t           hash_of         ( const _K2& key ) const
+            {
+                size_t h = (size_t)hash_( key );
+                if constexpr ( !is_avalanching<_Hash>::value )
+                    h = (size_t)hashing::mul_fold( (unsigned long long)h, hashing::prime64_1 );
+                return h;
+            }
+            // 7 bits kept in the control byte, the rest selects the group
+            static inline signed char h2_of         ( size_t h ) { return (signed char)( h & 0x7f ); }
+            inline size_t           first_group     ( size_t h ) const { return ( h >> 7 ) & ( capacity_ / group_size - 1 ); }
+            // next group (triangular steps visit all the groups when their count is a power of 2)
+            inline size_t           next_group      ( size_t g, size_t step ) const { return ( g + step ) & ( capacity_ / group_size - 1 ); }
+
+            // slot with the key or npos
+            template<typename _K2>
+            inline size_t           find_index      ( const _K2& key, size_t h ) const
+            {
+                if ( capacity_ == 0 )
+                    return npos;
+
+                const signed char h2 = h2_of( h );
+                size_t g = first_group( h );
+                for ( size_t step = 1; ; ++step )
+                {
+                    const size_t first = g * group_size;
+                    group grp( ctrl_ + first );
+                    for ( unsigned int m = grp.match( h2 ); m != 0; m &= m - 1 )
+                    {
+                        size_t i = first + lowest_bit( m );
+                        if ( equal_( _Policy::key( slots_[i] ), key ) )
+                            return i;
+                    }
+                    // the key would have been put in this group
+                    if ( grp.match_empty() != 0 )
+                        return npos;
+                    g = next_group( g, step );
+                }
+            }
+
+            // first empty or deleted slot for the hash (npos when there are no slots)
+            inline size_t           find_free       ( size_t h ) const
+            {
+                if ( capacity_ == 0 )
+                    return npos;
+
+                size_t g = first_group( h );
+                for ( size_t step = 1; ; ++step )
+                {
+                    unsigned int m = group( ctrl_ + g * group_size ).match_free();
+                    if ( m != 0 )
+                        return g * group_size + lowest_bit( m );
+                    g = next_group( g, step );
+                }
+            }
+
+            // a slot goes back to empty only when its group has an empty slot (no probe went past the group)
+            inline void             erase_at        ( size_t i )
+            {
+                slots_[i].~value_type();
+                --size_;
+                if ( group( ctrl_ + ( i & ~( group_size - 1 ) ) ).match_empty() != 0 )
+                {
+                    ctrl_[i] = ctrl_empty;
+                    ++growth_left_;
+                }
+                else
+                {
+                    ctrl_[i] = ctrl_deleted;
+                }
+            }
+
+
+            // 7/8 of the slots can be used
+            static inline size_t    max_load        ( size_t capacity ) { return capacity - capacity / 8; }
+            static inline size_t    capacity_for    ( size_t count )
+            {
+                if ( count == 0 )
+                    return 0;
+                size_t capacity = group_size;
+                while ( max_load( capacity ) < count )
+                    capacity *= 2;
+                return capacity;
+            }
+
+            // no room left, double or only drop the deleted slots when they are many
+            inline void             rehash_for_insert()
+            {
+                if ( capacity_ == 0 )
+                    rehash( group_size );
+                else if ( size_ < max_load( capacity_ ) / 2 )
+                    rehash( capacity_ );
+                else
+                    rehash( capacity_ * 2 );
+            }
+
+            // move all to new slots
+            inline void             rehash          ( size_t new_capacity )
+            {
+                signed char*    old_ctrl        = ctrl_;
+                value_type*     old_slots       = slots_;
+                size_t          old_capacity    = capacity_;
+
+                allocate( new_capacity );
+                for ( size_t i = 0; i < old_capacity; ++i )
+                {
+                    if ( old_ctrl[i] < 0 )
+                        continue;
+                    size_t h = hash_of( _Policy::key( old_slots[i] ) );
+                    size_t j = find_free( h );
+                    new ( slots_ + j ) value_type( std::move( old_slots[i] ) );
+                    old_slots[i].~value_type();
+                    ctrl_[j] = h2_of( h );
+                }
+                growth_left_ = max_load( capacity_ ) - size_;
+
+                deallocate( old_ctrl, old_slots, old_capacity );
+            }
+
+
+            // slots and control bytes (+1 for the sentinel), all empty
+            inline void             allocate        ( size_t capacity )
+            {
+                ctrl_       = static_cast<signed char*>( ::operator new( capacity + 1, std::align_val_t( group_size ) ) );
+                slots_      = std::allocator<value_type>().allocate( capacity );
+                capacity_   = capacity;
+                reset_ctrl();
+            }
+            static inline void      deallocate      ( signed char* ctrl, value_type* slots, size_t capacity )
+            {
+                if ( capacity == 0 )
+                    return;
+                ::operator delete( ctrl, std::align_val_t( group_size ) );
+                std::allocator<value_type>().deallocate( slots, capacity );
+            }
+            inline void             reset_ctrl      ()
+            {
+                memset( ctrl_, (unsigned char)ctrl_empty, capacity_ );
+                ctrl_[capacity_] = ctrl_sentinel;
+            }
+
+            inline void             destroy_slots   ()
+            {
+                if constexpr ( !std::is_trivially_destructible<value_type>::value )
+                {
+                    for ( size_t i = 0; i < capacity_; ++i )
+                        if ( ctrl_[i] >= 0 )
+                            slots_[i].~value_type();
+                }
+            }
+            inline void             destroy         ()
+            {
+                destroy_slots();
+                deallocate( ctrl_, slots_, capacity_ );
+                ctrl_ = nullptr; slots_ = nullptr; capacity_ = 0; size_ = 0; growth_left_ = 0;
+            }
+
+            // the same layout as o (slots are copied in place)
+            inline void             copy_from       ( const table& o )
+            {
+                if ( o.capacity_ == 0 )
+                    return;
+                allocate( o.capacity_ );
+                for ( size_t i = 0; i < capacity_; ++i )
+                {
+                    if ( o.ctrl_[i] >= 0 )
+                        new ( slots_ + i ) value_type( o.slots_[i] );
+                }
+                memcpy( ctrl_, o.ctrl_, capacity_ );
+                size_        = o.size_;
+                growth_left_ = o.growth_left_;
+            }
+            inline void             steal           ( table& o )
+            {
+                ctrl_        = o.ctrl_;         o.ctrl_         = nullptr;
+                slots_       = o.slots_;        o.slots_        = nullptr;
+                capacity_    = o.capacity_;     o.capacity_     = 0;
+                size_        = o.size_;         o.size_         = 0;
+                growth_left_ = o.growth_left_;  o.growth_left_  = 0;
+            }
+
+        private:
+            _Hash           hash_;
+            _Equal          equal_;
+            signed char*    ctrl_           = nullptr;
+            value_type*     slots_          = nullptr;
+            size_t          capacity_       = 0;
+            size_t          size_           = 0;
+            // inserts in empty slots before a rehash
+            size_t          growth_left_    = 0;
+        };
+    }
+}
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu_impl.h"
+
+//
+// word at a time 64 / 128 bit hash (same family as xxh3 / wyhash, not cryptographic)
+//
+// inputs up to 128 bytes are hashed with a few 64 x 64 -> 128 bit multiplications on overlapping words,
+// longer inputs are read in stripes of 64 bytes into 8 accumulators (sse2 / avx2 or scalar, same result),
+// the accumulators are scrambled after each block of 16 stripes and the last 64 bytes are always read
+// as a last stripe, so the value can also be computed in pieces (see small::hasher)
+//
+namespace small
+{
+    namespace hashing
+    {
+        const unsigned long long prime32_1 = 0x9E3779B1ULL;
+        const unsigned long long prime32_2 = 0x85EBCA77ULL;
+        const unsigned long long prime32_3 = 0xC2B2AE3DULL;
+        const unsigned long long prime64_1 = 0x9E3779B185EBCA87ULL;
+        const unsigned long long prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+        const unsigned long long prime64_3 = 0x165667B19E3779F9ULL;
+        const unsigned long long prime64_4 = 0x85EBCA77C2B2AE63ULL;
+        const unsigned long long prime64_5 = 0x27D4EB2F165667C5ULL;
+
+        // sizes
+        const size_t stripe_size        = 64;
+        const size_t stripes_per_block  = 16;
+        const size_t block_size         = stripe_size * stripes_per_block;
+        const size_t short_max_size     = 128;      // longer inputs use the stripes
+        const size_t secret_words       = 32;
+
+        // secret offsets (in words), stripe n of a block uses the 8 words from n
+        const size_t secret_scramble    = 24;
+        const size_t secret_last_stripe = 17;
+        const size_t secret_high        = 16;       // second half for the 128 bit values
+
+
+        // default secret (splitmix64 sequence)
+        struct secret_table
+        {
+            unsigned long long words[secret_words];
+        };
+
+        constexpr secret_table make_secret_table    ()
+        {
+            secret_table t = {};
+            unsigned long long x = 0x736d616c6c68736eULL;
+            for ( size_t i = 0; i < secret_words; ++i )
+            {
+                unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                t.words[i] = z ^ (z >> 31);
+            }
+            return t;
+        }
+
+        alignas(64) inline constexpr secret_table default_secret = make_secret_table();
+
+        // secret for a seed (0 uses the default one)
+        inline void     make_seeded_secret          ( unsigned long long* secret, unsigned long long seed )
+        {
+            for ( size_t i = 0; i < secret_words; i += 2 )
+            {
+                secret[i]     = default_secret.words[i]     + seed;
+                secret[i + 1] = default_secret.words[i + 1] - seed;
+            }
+        }
+
+
+
+
+        //
+        // primitives
+        //
+
+        // little endian reads
+        inline unsigned long long read64            ( const char* p ) { unsigned long long v; memcpy( &v, p, sizeof( v ) ); return v; }
+        inline unsigned long long read32            ( const char* p ) { unsigned int v; memcpy( &v, p, sizeof( v ) ); return v; }
+
+        // 64 x 64 -> 128 bit multiplication folded to 64 bits
+        inline unsigned long long mul_fold          ( unsigned long long a, unsigned long long b )
+        {
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 r = (unsigned __int128)a * b;
+            return (unsigned long long)r ^ (unsigned long long)(r >> 64);
+#else
+            unsigned long long a_lo = a & 0xFFFFFFFFULL, a_hi = a >> 32;
+            unsigned long long b_lo = b & 0xFFFFFFFFULL, b_hi = b >> 32;
+            unsigned long long lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+            unsigned long long cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+            unsigned long long upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+            unsigned long long lower = (cross << 32) | (lo_lo & 0xFFFFFFFFULL);
+            return lower ^ upper;
+#endif
+        }
+
+        // final mix
+        inline unsigned long long avalanche         ( unsigned long long h )
+        {
+            h ^= h >> 37;
+            h *= 0x165667919E3779F9ULL;
+            h ^= h >> 32;
+            return h;
+        }
+
+        // final mix for inputs up to 8 bytes
+        inline unsigned long long avalanche_small   ( unsigned long long h )
+        {
+            h ^= h >> 33;
+            h *= prime64_2;
+            h ^= h >> 29;
+            h *= prime64_3;
+            h ^= h >> 32;
+            return h;
+        }
+
+        // 16 bytes with 2 secret words
+        inline unsigned long long mix16             ( const char* p, const unsigned long long* secret, unsigned long long seed )
+        {
+            return mul_fold( read64( p ) ^ (secret[0] + seed), read64( p + 8 ) ^ (secret[1] - seed) );
+        }
+
+
+
+
+        //
+        // short inputs (0..128 bytes), 16 secret words
+        //
+        inline unsigned long long hash_short        ( const char* p, size_t length, unsigned long long seed, const unsigned long long* secret )
+        {
+            if ( length > 16 )
+            {
+                // pairs of 16 bytes from both ends
+                const char* end = p + length;
+                unsigned long long acc = length * prime64_1;
+                if ( length > 32 )
+                {
+                    if ( length > 64 )
+                    {
+                        if ( length > 96 )
+                        {
+                            acc += mix16( p + 48,   secret + 12, seed );
+                            acc += mix16( end - 64, secret + 14, seed );
+                        }
+                        acc += mix16( p + 32,   secret + 8,  seed );
+                        acc += mix16( end - 48, secret + 10, seed );
+                    }
+                    acc += mix16( p + 16,   secret + 4, seed );
+                    acc += mix16( end - 32, secret + 6, seed );
+                }
+                acc += mix16( p,        secret + 0, seed );
+                acc += mix16( end - 16, secret + 2, seed );
+                return avalanche( acc );
+            }
+            if ( length > 8 )
+            {
+                unsigned long long lo = read64( p )              ^ ((secret[4] ^ secret[5]) + seed);
+                unsigned long long hi = read64( p + length - 8 ) ^ ((secret[6] ^ secret[7]) - seed);
+                unsigned long long acc = length + (lo << 32 | lo >> 32) + hi + mul_fold( lo, hi );
+                return avalanche( acc );
+            }
+            if ( length >= 4 )
+            {
+                unsigned long long v = read32( p ) + (read32( p + length - 4 ) << 32);
+                unsigned long long k = (secret[2] ^ secret[3]) - seed;
+                return avalanche_small( (v ^ k) + length );
+            }
+            if ( length > 0 )
+            {
+                unsigned long long c1 = (unsigned char)p[0], c2 = (unsigned char)p[length >> 1], c3 = (unsigned char)p[length - 1];
+                unsigned long long v = (c1 << 16) | (c2 << 24) | c3 | ((unsigned long long)length << 8);
+                unsigned long long k = (secret[0] ^ secret[1]) + seed;
+                return avalanche_small( v ^ k );
+            }
+            return avalanche_small( seed ^ secret[8] ^ secret[9] );
+        }
+
+
+
+
+        //
+        // stripes
+        //
+
+        // initial accumulators
+        inline void     init_accumulators           ( unsigned long long* acc )
+        {
+            acc[0] = prime32_3; acc[1] = prime64_1; acc[2] = prime64_2; acc[3] = prime64_3;
+            acc[4] = prime64_4; acc[5] = prime32_2; acc[6] = prime64_5; acc[7] = prime32_1;
+        }
+
+        // stripe n uses the secret words from n
+        inline void     accumulate_scalar           ( unsigned long long* acc, const char* p, size_t stripes, const unsigned long long* secret )
+        {
+            for ( size_t n = 0; n < stripes; ++n, p += stripe_size )
+            {
+                for ( size_t i = 0; i < 8; ++i )
+                {
+                    unsigned long long d = read64( p + i * 8 );
+                    unsigned long long dk = d ^ secret[n + i];
+                    acc[i ^ 1] += d;
+                    acc[i] += (dk & 0xFFFFFFFFULL) * (dk >> 32);
+                }
+            }
+        }
+
+        inline void     scramble_scalar             ( unsigned long long* acc, const unsigned long long* secret )
+        {
+            for ( size_t i = 0; i < 8; ++i )
+            {
+                unsigned long long a = acc[i];
+                a ^= a >> 47;
+                a ^= secret[i];
+                acc[i] = a * prime32_1;
+            }
+        }
+
+#if defined(SMALL_SIMD_X86)
+        SMALL_TARGET("sse2")
+        inline void     accumulate_sse2             ( unsigned long long* acc, const char* p, size_t stripes, const unsigned long long* secret )
+        {
+            __m128i a[4];
+            for ( int i = 0; i < 4; ++i )
+                a[i] = _mm_loadu_si128( (const __m128i*)(acc + 2 * i) );
+
+            for ( size_t n = 0; n < stripes; ++n, p += stripe_size )
+            {
+                for ( int i = 0; i < 4; ++i )
+                {
+                    const __m128i d  = _mm_loadu_si128( (const __m128i*)(p + 16 * i) );
+                    const __m128i dk = _mm_xor_si128( d, _mm_loadu_si128( (const __m128i*)(secret + n + 2 * i) ) );
+                    const __m128i product = _mm_mul_epu32( dk, _mm_srli_epi64( dk, 32 ) );
+                    // acc[i ^ 1] += d
+                    a[i] = _mm_add_epi64( a[i], _mm_shuffle_epi32( d, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+                    a[i] = _mm_add_epi64( a[i], product );
+                }
+            }
+
+            for ( int i = 0; i < 4; ++i )
+                _mm_storeu_si128( (__m128i*)(acc + 2 * i), a[i] );
+        }
+
+        SMALL_TARGET("avx2")
+        inline void     accumulate_avx2             ( unsigned long long* acc, const char* p, size_t stripes, const unsigned long long* secret )
+        {
+            __m256i a0 = _mm256_loadu_si256( (const __m256i*)acc );
+            __m256i a1 = _mm256_loadu_si256( (const __m256i*)(acc + 4) );
+
+            for ( size_t n = 0; n < stripes; ++n, p += stripe_size )
+            {
+                const __m256i d0  = _mm256_loadu_si256( (const __m256i*)p );
+                const __m256i d1  = _mm256_loadu_si256( (const __m256i*)(p + 32) );
+                const __m256i dk0 = _mm256_xor_si256( d0, _mm256_loadu_si256( (const __m256i*)(secret + n) ) );
+                const __m256i dk1 = _mm256_xor_si256( d1, _mm256_loadu_si256( (const __m256i*)(secret + n + 4) ) );
+                a0 = _mm256_add_epi64( a0, _mm256_shuffle_epi32( d0, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+                a1 = _mm256_add_epi64( a1, _mm256_shuffle_epi32( d1, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+                a0 = _mm256_add_epi64( a0, _mm256_mul_epu32( dk0, _mm256_srli_epi64( dk0, 32 ) ) );
+                a1 = _mm256_add_epi64( a1, _mm256_mul_epu32( dk1, _mm256_srli_epi64( dk1, 32 ) ) );
+            }
+
+            _mm256_storeu_si256( (__m256i*)acc, a0 );
+            _mm256_storeu_si256( (__m256i*)(acc + 4), a1 );
+        }
+#endif // SMALL_SIMD_X86
+
+        // accumulate stripes with the best kernel available
+        inline void     accumulate                  ( unsigned long long* acc, const char* p, size_t stripes, const unsigned long long* secret )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:
+            case cpu::EnumSimdLevel::kSimd_AVX2:    accumulate_avx2( acc, p, stripes, secret ); return;
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   accumulate_sse2( acc, p, stripes, secret ); return;
+            default: break;
+            }
+#endif
+            accumulate_scalar( acc, p, stripes, secret );
+        }
+
+        // whole blocks (each one followed by a scramble)
+        inline void     accumulate_blocks           ( unsigned long long* acc, const char* p, size_t blocks, const unsigned long long* secret )
+        {
+            for ( size_t b = 0; b < blocks; ++b, p += block_size )
+            {
+                accumulate( acc, p, stripes_per_block, secret );
+                scramble_scalar( acc, secret + secret_scramble );
+            }
+        }
+
+        // accumulators -> 64 bit value
+        inline unsigned long long merge_accumulators( const unsigned long long* acc, const unsigned long long* secret, unsigned long long start )
+        {
+            unsigned long long result = start;
+            for ( size_t i = 0; i < 8; i += 2 )
+                result += mul_fold( acc[i] ^ secret[i], acc[i + 1] ^ secret[i + 1] );
+            return avalanche( result );
+        }
+
+        // last part of a long input: stripes after the last whole block and the last 64 bytes of the input
+        // (tail is the data after the last whole block, 1..block_size bytes, last_stripe points to the last 64 bytes)
+        inline void     accumulate_tail             ( unsigned long long* acc, const char* tail, size_t tail_length, const char* last_stripe, const unsigned long long* secret )
+        {
+            accumulate( acc, tail, (tail_length - 1) / stripe_size, secret );
+            accumulate( acc, last_stripe, 1, secret + secret_last_stripe );
+        }
+
+
+
+
+        //
+        // values
+        //
+
+        // 64 bit hash
+        inline unsigned long long hash64            ( const char* p, size_t length, unsigned long long seed )
+        {
+            if ( length <= short_max_size )
+                return hash_short( p, length, seed, default_secret.words );
+
+            alignas(32) unsigned long long seeded[secret_words];
+            const unsigned long long* secret = default_secret.words;
+            if ( seed != 0 )
+            {
+                make_seeded_secret( seeded, seed );
+                secret = seeded;
+            }
+
+            alignas(32) unsigned long long acc[8];
+            init_accumulators( acc );
+            size_t blocks = (length - 1) / block_size;
+            accumulate_blocks( acc, p, blocks, secret );
+            accumulate_tail( acc, p + blocks * block_size, length - blocks * block_size, p + length - stripe_size, secret );
+            return merge_accumulators( acc, secret, length * prime64_1 );
+        }
+
+        // 128 bit hash (low, high)
+        inline void     hash128                     ( const char* p, size_t length, unsigned long long seed, unsigned long long* low, unsigned long long* high )
+        {
+            if ( length <= short_max_size )
+            {
+                *low  = hash_short( p, length, seed, default_secret.words );
+                *high = hash_short( p, length, seed, default_secret.words + secret_high );
+                return;
+            }
+
+            alignas(32) unsigned long long seeded[secret_words];
+            const unsigned long long* secret = default_secret.words;
+            if ( seed != 0 )
+            {
+                make_seeded_secret( seeded, seed );
+                secret = seeded;
+            }
+
+            alignas(32) unsigned long long acc[8];
+            init_accumulators( acc );
+            size_t blocks = (length - 1) / block_size;
+            accumulate_blocks( acc, p, blocks, secret );
+            accumulate_tail( acc, p + blocks * block_size, length - blocks * block_size, p + length - stripe_size, secret );
+            *low  = merge_accumulators( acc, secret, length * prime64_1 );
+            *high = merge_accumulators( acc, secret + secret_high, ~(length * prime64_2) );
+        }
+    }
+}
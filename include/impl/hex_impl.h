@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "hex_simd_impl.h"
+
+
+namespace small
+{
+    namespace hex
+    {
+        // error position when there is no error
+        const size_t npos = (size_t)-1;
+
+        // value of each hex digit (any case), -1 when it is not a hex digit
+        struct digit_table
+        {
+            signed char     index[256];
+        };
+
+        constexpr digit_table make_digit_table      ()
+        {
+            digit_table t = {};
+            for ( int i = 0; i < 256; ++i )
+                t.index[i] = -1;
+            for ( int i = 0; i < 10; ++i )
+                t.index['0' + i] = (signed char)i;
+            for ( int i = 0; i < 6; ++i )
+            {
+                t.index['a' + i] = (signed char)(10 + i);
+                t.index['A' + i] = (signed char)(10 + i);
+            }
+            return t;
+        }
+
+        alignas(64) inline constexpr digit_table digit_index = make_digit_table();
+
+
+
+
+        // get hex size (without null ending char)
+        inline size_t   get_hex_size                ( const size_t& length ) { return length * 2; }
+
+        // to hex one byte at a time (reference implementation, also used for the tail after simd)
+        template<typename _Case = lower>
+        inline void     tohex_scalar                ( char* hex, const char* src, const size_t& src_length )
+        {
+            for ( size_t i = 0; i < src_length; ++i )
+            {
+                unsigned char ch = (unsigned char)src[i];
+                *hex++ = _Case::chars[ch >> 4];
+                *hex++ = _Case::chars[ch & 0x0f];
+            }
+        }
+
+        // to hex (buffer must be proper allocated using get_hex_size)
+        template<typename _Case = lower>
+        inline void     tohex                       ( char* hex, const char* src, const size_t& src_length )
+        {
+            size_t done = tohex_simd<_Case>( hex, src, src_length );
+            tohex_scalar<_Case>( hex + done * 2, src + done, src_length - done );
+        }
+
+        // 64 bit value as 16 hex digits, most significant first (for hashes)
+        template<typename _Case = lower>
+        inline void     tohex_u64                   ( char* hex, unsigned long long value )
+        {
+            for ( int i = 15; i >= 0; --i, value >>= 4 )
+                hex[i] = _Case::chars[value & 0x0f];
+        }
+
+
+
+
+        // get decoded size
+        inline size_t   get_decodedhex_size         ( const size_t& hex_length ) { return hex_length / 2; }
+
+        // decode hex (any case), stops at the first char that is not a hex digit (returns decoded length)
+        // error_position is set to the offset of that char, to hex_length when the length is odd, or to npos
+        inline size_t   fromhex                     ( char* decoded, const char* hex, const size_t& hex_length, size_t* error_position = nullptr )
+        {
+            size_t done = fromhex_simd( decoded, hex, hex_length );
+            char* out = decoded + done / 2;
+
+            size_t error = npos;
+            const signed char* index = digit_index.index;
+            for ( ; done + 1 < hex_length; done += 2 )
+            {
+                int hi = index[(unsigned char)hex[done]];
+                int lo = index[(unsigned char)hex[done + 1]];
+                if ( (hi | lo) < 0 )
+                {
+                    error = hi < 0 ? done : done + 1;
+                    break;
+                }
+                *out++ = (char)(hi << 4 | lo);
+            }
+            if ( error == npos && done < hex_length )
+                error = index[(unsigned char)hex[done]] < 0 ? done : hex_length;
+
+            if ( error_position )
+                *error_position = error;
+            return (size_t)(out - decoded);
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu_impl.h"
+
+//
+// hex alphabets and vectorized kernels
+// each kernel processes only whole blocks and returns how many input bytes were consumed,
+// the rest is done by the scalar code
+//
+namespace small
+{
+    namespace hex
+    {
+        // lower case digits (default)
+        struct lower
+        {
+            static constexpr char   chars[17] = "0123456789abcdef";
+        };
+
+        // upper case digits
+        struct upper
+        {
+            static constexpr char   chars[17] = "0123456789ABCDEF";
+        };
+
+
+#if defined(SMALL_SIMD_X86)
+        //
+        // encode
+        //
+
+        // encode blocks of 16 bytes -> 32 chars
+        template<typename _Case>
+        SMALL_TARGET("ssse3")
+        inline size_t   tohex_ssse3                 ( char* hex, const char* src, size_t src_length )
+        {
+            const __m128i digits    = _mm_loadu_si128( (const __m128i*)_Case::chars );
+            const __m128i mask_0f   = _mm_set1_epi8( 0x0f );
+
+            size_t done = 0;
+            while ( src_length - done >= 16 )
+            {
+                const __m128i in = _mm_loadu_si128( (const __m128i*)(src + done) );
+                const __m128i hi = _mm_shuffle_epi8( digits, _mm_and_si128( _mm_srli_epi16( in, 4 ), mask_0f ) );
+                const __m128i lo = _mm_shuffle_epi8( digits, _mm_and_si128( in, mask_0f ) );
+                _mm_storeu_si128( (__m128i*)hex,        _mm_unpacklo_epi8( hi, lo ) );
+                _mm_storeu_si128( (__m128i*)(hex + 16), _mm_unpackhi_epi8( hi, lo ) );
+                hex     += 32;
+                done    += 16;
+            }
+            return done;
+        }
+
+        // encode blocks of 32 bytes -> 64 chars
+        template<typename _Case>
+        SMALL_TARGET("avx2")
+        inline size_t   tohex_avx2                  ( char* hex, const char* src, size_t src_length )
+        {
+            const __m256i digits    = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)_Case::chars ) );
+            const __m256i mask_0f   = _mm256_set1_epi8( 0x0f );
+
+            size_t done = 0;
+            while ( src_length - done >= 32 )
+            {
+                // quads 0 2 1 3 so the unpacks (in lane) give the chars in order
+                const __m256i in = _mm256_permute4x64_epi64( _mm256_loadu_si256( (const __m256i*)(src + done) ), 0xd8 );
+                const __m256i hi = _mm256_shuffle_epi8( digits, _mm256_and_si256( _mm256_srli_epi16( in, 4 ), mask_0f ) );
+                const __m256i lo = _mm256_shuffle_epi8( digits, _mm256_and_si256( in, mask_0f ) );
+                _mm256_storeu_si256( (__m256i*)hex,        _mm256_unpacklo_epi8( hi, lo ) );
+                _mm256_storeu_si256( (__m256i*)(hex + 32), _mm256_unpackhi_epi8( hi, lo ) );
+                hex     += 64;
+                done    += 32;
+            }
+            return done;
+        }
+
+
+
+
+        //
+        // decode
+        //
+
+        // hex chars (any case) -> 4 bit values, returns false if any char is not a hex digit
+        SMALL_TARGET("ssse3")
+        inline bool     dec_translate_ssse3         ( __m128i& in )
+        {
+            // ranges (unsigned x <= max is min(x, max) == x)
+            const __m128i dig       = _mm_sub_epi8( in, _mm_set1_epi8( '0' ) );
+            const __m128i letter    = _mm_sub_epi8( _mm_or_si128( in, _mm_set1_epi8( 0x20 ) ), _mm_set1_epi8( 'a' ) );
+            const __m128i is_dig    = _mm_cmpeq_epi8( _mm_min_epu8( dig,    _mm_set1_epi8( 9 ) ), dig );
+            const __m128i is_letter = _mm_cmpeq_epi8( _mm_min_epu8( letter, _mm_set1_epi8( 5 ) ), letter );
+            if ( _mm_movemask_epi8( _mm_or_si128( is_dig, is_letter ) ) != 0xffff )
+                return false;
+
+            in = _mm_or_si128( _mm_and_si128( is_dig, dig ), _mm_and_si128( is_letter, _mm_add_epi8( letter, _mm_set1_epi8( 10 ) ) ) );
+            return true;
+        }
+
+        // decode blocks of 32 chars -> 16 bytes
+        SMALL_TARGET("ssse3")
+        inline size_t   fromhex_ssse3               ( char* decoded, const char* hex, size_t hex_length )
+        {
+            // (hi << 4) + lo for each pair
+            const __m128i pair = _mm_set1_epi16( 0x0110 );
+
+            size_t done = 0;
+            while ( hex_length - done >= 32 )
+            {
+                __m128i in0 = _mm_loadu_si128( (const __m128i*)(hex + done) );
+                __m128i in1 = _mm_loadu_si128( (const __m128i*)(hex + done + 16) );
+                if ( !dec_translate_ssse3( in0 ) || !dec_translate_ssse3( in1 ) )
+                    break;
+
+                const __m128i out = _mm_packus_epi16( _mm_maddubs_epi16( in0, pair ), _mm_maddubs_epi16( in1, pair ) );
+                _mm_storeu_si128( (__m128i*)decoded, out );
+                decoded += 16;
+                done    += 32;
+            }
+            return done;
+        }
+
+
+        // hex chars (any case) -> 4 bit values, returns false if any char is not a hex digit
+        SMALL_TARGET("avx2")
+        inline bool     dec_translate_avx2          ( __m256i& in )
+        {
+            const __m256i dig       = _mm256_sub_epi8( in, _mm256_set1_epi8( '0' ) );
+            const __m256i letter    = _mm256_sub_epi8( _mm256_or_si256( in, _mm256_set1_epi8( 0x20 ) ), _mm256_set1_epi8( 'a' ) );
+            const __m256i is_dig    = _mm256_cmpeq_epi8( _mm256_min_epu8( dig,    _mm256_set1_epi8( 9 ) ), dig );
+            const __m256i is_letter = _mm256_cmpeq_epi8( _mm256_min_epu8( letter, _mm256_set1_epi8( 5 ) ), letter );
+            if ( (unsigned int)_mm256_movemask_epi8( _mm256_or_si256( is_dig, is_letter ) ) != 0xffffffffu )
+                return false;
+
+            in = _mm256_or_si256( _mm256_and_si256( is_dig, dig ), _mm256_and_si256( is_letter, _mm256_add_epi8( letter, _mm256_set1_epi8( 10 ) ) ) );
+            return true;
+        }
+
+        // decode blocks of 64 chars -> 32 bytes
+        SMALL_TARGET("avx2")
+        inline size_t   fromhex_avx2                ( char* decoded, const char* hex, size_t hex_length )
+        {
+            const __m256i pair = _mm256_set1_epi16( 0x0110 );
+
+            size_t done = 0;
+            while ( hex_length - done >= 64 )
+            {
+                __m256i in0 = _mm256_loadu_si256( (const __m256i*)(hex + done) );
+                __m256i in1 = _mm256_loadu_si256( (const __m256i*)(hex + done + 32) );
+                if ( !dec_translate_avx2( in0 ) || !dec_translate_avx2( in1 ) )
+                    break;
+
+                // the pack is in lane, quads 0 2 1 3 put the bytes back in order
+                const __m256i out = _mm256_packus_epi16( _mm256_maddubs_epi16( in0, pair ), _mm256_maddubs_epi16( in1, pair ) );
+                _mm256_storeu_si256( (__m256i*)decoded, _mm256_permute4x64_epi64( out, 0xd8 ) );
+                decoded += 32;
+                done    += 64;
+            }
+            return done;
+        }
+#endif // SMALL_SIMD_X86
+
+
+        // encode whole blocks with the best kernel available (returns source bytes consumed)
+        template<typename _Case = lower>
+        inline size_t   tohex_simd                  ( char* hex, const char* src, size_t src_length )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:
+            case cpu::EnumSimdLevel::kSimd_AVX2:    return tohex_avx2 <_Case>( hex, src, src_length );
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   return tohex_ssse3<_Case>( hex, src, src_length );
+            default: break;
+            }
+#endif
+            (void)hex; (void)src; (void)src_length;
+            return 0;
+        }
+
+        // decode whole blocks of hex digits with the best kernel available (returns hex chars consumed,
+        // always even, it stops at the first block with a char that is not a hex digit)
+        inline size_t   fromhex_simd                ( char* decoded, const char* hex, size_t hex_length )
+        {
+#if defined(SMALL_SIMD_X86)
+            switch ( cpu::get_simd_level() )
+            {
+            case cpu::EnumSimdLevel::kSimd_AVX512:
+            case cpu::EnumSimdLevel::kSimd_AVX2:    return fromhex_avx2 ( decoded, hex, hex_length );
+            case cpu::EnumSimdLevel::kSimd_SSSE3:   return fromhex_ssse3( decoded, hex, hex_length );
+            default: break;
+            }
+#endif
+            (void)decoded; (void)hex; (void)hex_length;
+            return 0;
+        }
+    }
+}
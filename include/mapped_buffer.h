@@ -0,0 +1,375 @@
+#pragma once
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "impl/base_buffer_impl.h"
+
+//
+// memory mapped file as a buffer (posix)
+//
+// small::mapped_buffer m( "dump.b64" );  // read only by default
+// if ( m.is_open() )
+// {
+//     m.advise( small::EnumMappedAdvice::kAdvice_Sequential );
+//     small::buffer decoded = small::frombase64_b( m.data(), m.size() );
+// }
+//
+// small::mapped_buffer w( "out.log", small::EnumMappedMode::kMapped_ReadWrite ); // grows the file with ftruncate + mremap
+// w.append( "line\n" );
+// w.close(); // file is truncated to size()
+//
+// !! unlike buffer the data is not ended with '\0'
+//
+namespace small
+{
+    // open mode
+    enum class EnumMappedMode
+    {
+        kMapped_ReadOnly,       // changes are ignored
+        kMapped_CopyOnWrite,    // changes are private (not written to file), it cannot grow over the mapped pages
+        kMapped_ReadWrite,      // changes are written to file, it can grow
+    };
+
+    // madvise hints
+    enum class EnumMappedAdvice
+    {
+        kAdvice_Normal,
+        kAdvice_Sequential,
+        kAdvice_Random,
+        kAdvice_WillNeed,
+        kAdvice_DontNeed,
+    };
+
+
+    // class for representing a memory mapped file as a buffer
+    class mapped_buffer : public base_buffer
+    {
+    public:
+        // mapped_buffer
+        mapped_buffer                               () { setup_buffer( (char*)get_empty_buffer(), 0 ); }
+        mapped_buffer                               ( const char* path, EnumMappedMode mode = EnumMappedMode::kMapped_ReadOnly ) : mapped_buffer() { open( path, mode ); }
+        mapped_buffer                               ( mapped_buffer&& o ) noexcept : mapped_buffer() { operator=( std::forward<mapped_buffer>( o ) ); }
+        ~mapped_buffer                              () { close(); }
+
+        mapped_buffer                               ( const mapped_buffer& ) = delete;
+        mapped_buffer&  operator=                   ( const mapped_buffer& ) = delete;
+
+        // move operator
+        inline mapped_buffer& operator=             ( mapped_buffer&& o ) noexcept
+        {
+            if ( this != &o )
+            {
+                close();
+                fd_             = o.fd_;
+                mode_           = o.mode_;
+                map_data_       = o.map_data_;
+                map_size_       = o.map_size_;
+                length_         = o.length_;
+                file_size_      = o.file_size_;
+                remap_count_    = o.remap_count_;
+                start_faults_   = o.start_faults_;
+                setup_buffer( map_data_ ? map_data_ : (char*)get_empty_buffer(), length_ );
+
+                o.fd_           = -1;
+                o.map_data_     = nullptr;
+                o.map_size_     = 0;
+                o.length_       = 0;
+                o.file_size_    = 0;
+                o.setup_buffer( (char*)o.get_empty_buffer(), 0 );
+            }
+            return *this;
+        }
+
+
+        // open (returns false on error, see errno)
+        inline bool     open                        ( const char* path, EnumMappedMode mode = EnumMappedMode::kMapped_ReadOnly )
+        {
+            close();
+
+            int flags = mode == EnumMappedMode::kMapped_ReadWrite ? (O_RDWR | O_CREAT) : O_RDONLY;
+            int fd = ::open( path, flags, 0644 );
+            if ( fd < 0 )
+                return false;
+
+            struct stat st;
+            if ( fstat( fd, &st ) != 0 )
+            {
+                ::close( fd );
+                return false;
+            }
+
+            fd_             = fd;
+            mode_           = mode;
+            file_size_      = (size_t)st.st_size;
+            length_         = file_size_;
+            remap_count_    = 0;
+            start_faults_   = get_process_page_faults();
+
+            if ( !map( round_to_page( file_size_ ) ) )
+            {
+                close();
+                return false;
+            }
+            setup_buffer( map_data_ ? map_data_ : (char*)get_empty_buffer(), length_ );
+            return true;
+        }
+
+        // close (read write files are truncated to size)
+        inline void     close                       ()
+        {
+            if ( map_data_ )
+            {
+                munmap( map_data_, map_size_ );
+            }
+            if ( fd_ >= 0 )
+            {
+                if ( mode_ == EnumMappedMode::kMapped_ReadWrite && file_size_ != length_ )
+                {
+                    (void)!ftruncate( fd_, (off_t)length_ );
+                }
+                ::close( fd_ );
+            }
+            fd_         = -1;
+            map_data_   = nullptr;
+            map_size_   = 0;
+            length_     = 0;
+            file_size_  = 0;
+            setup_buffer( (char*)get_empty_buffer(), 0 );
+        }
+
+        // is open
+        inline bool     is_open                     () const { return fd_ >= 0; }
+        inline EnumMappedMode get_mode              () const { return mode_; }
+
+
+        // flush changes to file (read write mode)
+        inline bool     sync                        ( bool async = false )
+        {
+            if ( map_data_ == nullptr || mode_ != EnumMappedMode::kMapped_ReadWrite )
+                return true;
+            return msync( map_data_, map_size_, async ? MS_ASYNC : MS_SYNC ) == 0;
+        }
+
+        // madvise hints for a range (by default all)
+        inline bool     advise                      ( EnumMappedAdvice advice, size_t from = 0, size_t length = (size_t)-1 )
+        {
+            if ( map_data_ == nullptr || from >= map_size_ )
+                return false;
+
+            size_t start = (from / page_size()) * page_size();
+            size_t end   = length > map_size_ - from ? map_size_ : from + length;
+
+            int a = MADV_NORMAL;
+            switch ( advice )
+            {
+            case EnumMappedAdvice::kAdvice_Normal:     a = MADV_NORMAL;     break;
+            case EnumMappedAdvice::kAdvice_Sequential: a = MADV_SEQUENTIAL; break;
+            case EnumMappedAdvice::kAdvice_Random:     a = MADV_RANDOM;     break;
+            case EnumMappedAdvice::kAdvice_WillNeed:   a = MADV_WILLNEED;   break;
+            case EnumMappedAdvice::kAdvice_DontNeed:   a = MADV_DONTNEED;   break;
+            }
+            return madvise( map_data_ + start, end - start, a ) == 0;
+        }
+
+
+        // counters
+        // mapped size (pages)
+        inline size_t   get_mapped_size             () const { return map_size_; }
+        // how many times the mapping was changed to grow or shrink
+        inline size_t   get_remap_count             () const { return remap_count_; }
+        // page faults (minor + major) of the process since open
+        inline long     get_page_faults             () const { return get_process_page_faults() - start_faults_; }
+        // size of the mapped pages that are in memory
+        inline size_t   get_resident_size           () const
+        {
+            if ( map_data_ == nullptr )
+                return 0;
+
+            std::vector<unsigned char> pages( map_size_ / page_size() );
+            if ( mincore( map_data_, map_size_, (unsigned char*)pages.data() ) != 0 )
+                return 0;
+
+            size_t resident = 0;
+            for ( auto p : pages )
+                resident += (p & 1) ? page_size() : 0;
+            return resident;
+        }
+
+
+    private:
+        // page size
+        static inline size_t page_size              () { static size_t size = (size_t)sysconf( _SC_PAGESIZE ); return size; }
+        static inline size_t round_to_page          ( size_t size ) { return ((size + page_size() - 1) / page_size()) * page_size(); }
+
+        // process page faults
+        static inline long get_process_page_faults  ()
+        {
+            struct rusage usage;
+            if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+                return 0;
+            return usage.ru_minflt + usage.ru_majflt;
+        }
+
+        // map (or remap) to new_map_size
+        inline bool     map                         ( size_t new_map_size )
+        {
+            if ( new_map_size == map_size_ )
+                return true;
+
+            // read write keeps the file as big as the mapping so every mapped page can be accessed
+            if ( mode_ == EnumMappedMode::kMapped_ReadWrite && file_size_ != new_map_size )
+            {
+                if ( ftruncate( fd_, (off_t)new_map_size ) != 0 )
+                    return false;
+                file_size_ = new_map_size;
+            }
+
+            if ( new_map_size == 0 )
+            {
+                if ( map_data_ )
+                    munmap( map_data_, map_size_ );
+                map_data_ = nullptr;
+                map_size_ = 0;
+                ++remap_count_;
+                return true;
+            }
+
+            int prot  = mode_ == EnumMappedMode::kMapped_ReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE);
+            int flags = mode_ == EnumMappedMode::kMapped_ReadWrite ? MAP_SHARED : MAP_PRIVATE;
+
+            void* p = MAP_FAILED;
+#ifdef MREMAP_MAYMOVE
+            if ( map_data_ )
+                p = mremap( map_data_, map_size_, new_map_size, MREMAP_MAYMOVE );
+            else
+                p = mmap( nullptr, new_map_size, prot, flags, fd_, 0 );
+#else
+            p = mmap( nullptr, new_map_size, prot, flags, fd_, 0 );
+            if ( p != MAP_FAILED && map_data_ )
+            {
+                if ( mode_ == EnumMappedMode::kMapped_CopyOnWrite )
+                    memcpy( p, map_data_, map_size_ < new_map_size ? map_size_ : new_map_size );
+                munmap( map_data_, map_size_ );
+            }
+#endif
+            if ( p == MAP_FAILED )
+                return false;
+
+            if ( map_data_ )
+                ++remap_count_;
+            map_data_ = (char*)p;
+            map_size_ = new_map_size;
+            return true;
+        }
+
+        // make room for new_size (only read write mode can grow)
+        inline bool     ensure_size                 ( size_t new_size )
+        {
+            if ( new_size <= map_size_ )
+                return mode_ != EnumMappedMode::kMapped_ReadOnly;
+            if ( mode_ != EnumMappedMode::kMapped_ReadWrite )
+                return false;
+
+            // grow 2x to avoid remapping on every append
+            size_t new_map_size = map_size_ * 2 > new_size ? map_size_ * 2 : new_size;
+            return map( round_to_page( new_map_size ) );
+        }
+
+
+        // !! override functions
+        void            clear_impl                  () override
+        {
+            if ( mode_ != EnumMappedMode::kMapped_ReadOnly )
+                length_ = 0;
+            setup_buffer( map_data_ ? map_data_ : (char*)get_empty_buffer(), length_ );
+        }
+
+        void            reserve_impl                ( size_t new_size ) override
+        {
+            ensure_size( new_size );
+            setup_buffer( map_data_ ? map_data_ : (char*)get_empty_buffer(), length_ );
+        }
+
+        void            resize_impl                 ( size_t new_size ) override
+        {
+            if ( ensure_size( new_size ) )
+                length_ = new_size;
+            setup_buffer( map_data_ ? map_data_ : (char*)get_empty_buffer(), length_ );
+        }
+
+        void            shrink_impl                 () override
+        {
+            if ( mode_ == EnumMappedMode::kMapped_ReadWrite )
+                map( round_to_page( length_ ) );
+            setup_buffer( map_data_ ? map_data_ : (char*)get_empty_buffer(), length_ );
+        }
+
+        // room for direct write (nullptr when read only or the mapping cannot grow)
+        char*           prepare_impl                ( size_t n ) override
+        {
+            if ( !ensure_size( length_ + n ) )
+                return nullptr;
+            setup_buffer( map_data_ ? map_data_ : (char*)get_empty_buffer(), length_ );
+            return map_data_ ? map_data_ + length_ : nullptr;
+        }
+
+        void            commit_impl                 ( size_t n ) override
+        {
+            resize_impl( length_ + n );
+        }
+
+        // changes are done only if there is room for them (read only ignores all changes)
+        void            set_impl                    ( size_t from, const char* buffer, size_t length ) override
+        {
+            if ( ensure_size( from + length ) )
+                buffer_set_impl( from, buffer, length );
+        }
+        void            set_impl                    ( size_t from, const wchar_t* buffer, size_t length ) override
+        {
+            if ( ensure_size( from + sizeof( wchar_t ) * length ) )
+                buffer_set_impl( from, (const char*)buffer, sizeof( wchar_t ) * length );
+        }
+
+        void            insert_impl                 ( size_t from, const char* buffer, size_t length ) override
+        {
+            if ( ensure_size( (from > length_ ? from : length_) + length ) )
+                buffer_insert_impl( from, buffer, length );
+        }
+        void            insert_impl                 ( size_t from, const wchar_t* buffer, size_t length ) override
+        {
+            if ( ensure_size( (from > length_ ? from : length_) + sizeof( wchar_t ) * length ) )
+                buffer_insert_impl( from, (const char*)buffer, sizeof( wchar_t ) * length );
+        }
+
+        void            erase_impl                  ( size_t from, size_t length ) override
+        {
+            if ( mode_ != EnumMappedMode::kMapped_ReadOnly )
+                buffer_erase_impl( from, length );
+        }
+
+
+    private:
+        // file
+        int             fd_{ -1 };
+        EnumMappedMode  mode_{ EnumMappedMode::kMapped_ReadOnly };
+        // mapping
+        char *          map_data_{ nullptr };
+        size_t          map_size_{ 0 };
+        // data length (can be less than file size while mapped)
+        size_t          length_{ 0 };
+        size_t          file_size_{ 0 };
+        // counters
+        size_t          remap_count_{ 0 };
+        long            start_faults_{ 0 };
+    };
+}
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <string.h>
+#include <stddef.h>
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "buffer.h"
+
+//
+// small::segmented_buffer sb;
+// sb.append( body, body_length );      // O(1), no realloc of the data written so far
+// sb.prepend( "header\r\n" );          // O(1), a new segment in front
+// sb.insert( 6, ": value" );           // only the touched segment is split
+//
+// for ( size_t i = 0; i < sb.segments_count(); ++i )
+// {
+//     std::string_view s = sb.segment( i );
+//     ...
+// }
+//
+// small::buffer b = sb.flatten();      // contiguous copy only when asked
+//
+namespace small
+{
+    const size_t default_segment_size = 64 * 1024;
+
+    // class for representing a buffer as a list of segments
+    class segmented_buffer
+    {
+    public:
+        // segmented_buffer (each segment is one allocation of segment_size)
+        segmented_buffer                            ( size_t segment_size = default_segment_size, buffer_allocator* allocator = nullptr )
+                                                        : segment_size_( segment_size > 1 ? segment_size : 2 ), allocator_( allocator ) {}
+
+        segmented_buffer                            ( const segmented_buffer& o ) = default;
+        segmented_buffer                            ( segmented_buffer&& o ) noexcept = default;
+        segmented_buffer&   operator=               ( const segmented_buffer& o ) = default;
+        segmented_buffer&   operator=               ( segmented_buffer&& o ) noexcept = default;
+
+
+        // size / length / empty
+        inline size_t   size                        () const    { return length_; }
+        inline size_t   length                      () const    { return size(); }
+        inline bool     empty                       () const    { return size() == 0; }
+
+        // segment size
+        inline size_t   get_segment_size            () const    { return segment_size_; }
+
+        // clear
+        inline void     clear                       ()          { segments_.clear(); length_ = 0; }
+
+        // resize (new data is zero)
+        inline void     resize                      ( size_t new_size )
+        {
+            if ( new_size < size() )
+            {
+                erase( new_size );
+                return;
+            }
+
+            std::vector<char> zero( segment_size_ < new_size - size() ? segment_size_ : new_size - size(), '\0' );
+            while ( size() < new_size )
+            {
+                size_t n = new_size - size() < zero.size() ? new_size - size() : zero.size();
+                append( zero.data(), n );
+            }
+        }
+
+
+
+        // segments
+        inline size_t   segments_count              () const            { return segments_.size(); }
+        inline std::string_view segment             ( size_t index ) const { return segments_[index].c_view(); }
+        inline buffer&  segment_buffer              ( size_t index )    { return segments_[index]; }
+
+        // call fn( std::string_view ) for each segment
+        template<typename _Callable>
+        inline void     for_each_segment            ( _Callable fn ) const { for ( auto& s : segments_ ) { fn( s.c_view() ); } }
+
+
+        // direct write into spare room
+        // prepare calls fn( char*, size_t ) for each region that together have at least n bytes
+        // (the room left in the last segment and new segments), then commit the written bytes
+        template<typename _Callable>
+        inline void     prepare                     ( size_t n, _Callable fn )
+        {
+            size_t index = segments_.size();
+            if ( !segments_.empty() && segments_.back().get_chunk_size() == segment_size_ && segments_.back().size() < segment_capacity() )
+            {
+                // a partly filled segment may have less allocated than a whole segment (growth policy)
+                --index;
+                segments_.back().reserve( segment_capacity() );
+            }
+
+            // add segments until there is enough room (stops when a segment cannot be allocated)
+            size_t room = 0;
+            for ( size_t i = index; i < segments_.size(); ++i )
+                room += segment_room( segments_[i] );
+            while ( room < n )
+            {
+                segments_.emplace_back( new_segment() );
+                segments_.back().reserve( segment_capacity() );
+                size_t m = segment_room( segments_.back() );
+                if ( m == 0 )
+                {
+                    segments_.pop_back();
+                    break;
+                }
+                room += m;
+            }
+
+            for ( size_t i = index; i < segments_.size(); ++i )
+            {
+                auto& sg = segments_[i];
+                size_t m = segment_room( sg );
+                if ( m > 0 )
+                    fn( sg.data() + sg.size(), m );
+            }
+        }
+
+        // commit n bytes written in the regions given by prepare
+        inline void     commit                      ( size_t n )
+        {
+            // prepared segments are the trailing empty ones and the one before if it has room
+            size_t index = segments_.size();
+            while ( index > 0 && segments_[index - 1].empty() )
+                --index;
+            if ( index > 0 && segments_[index - 1].get_chunk_size() == segment_size_ && segments_[index - 1].size() < segment_capacity() )
+                --index;
+
+            for ( ; index < segments_.size() && n > 0; ++index )
+            {
+                auto& sg = segments_[index];
+                size_t m = segment_room( sg );
+                if ( m > n )
+                    m = n;
+                sg.resize( sg.size() + m );
+                length_ += m;
+                n       -= m;
+            }
+
+            // remove unused prepared segments
+            while ( !segments_.empty() && segments_.back().empty() )
+                segments_.pop_back();
+        }
+
+
+        // flatten to a contiguous buffer
+        inline small::buffer flatten                () const            { small::buffer b; flatten( b ); return b; }
+        inline void     flatten                     ( small::buffer& b ) const
+        {
+            b.clear();
+            b.reserve( size() );
+            for ( auto& s : segments_ )
+                b.append( s.data(), s.size() );
+        }
+
+        // conversion as c_string
+        inline std::string      c_string            () const    { std::string s; s.reserve( size() ); for ( auto& sg : segments_ ) { s.append( sg.data(), sg.size() ); } return s; }
+
+
+        // assign
+        inline void     assign                      ( const base_buffer& b      )   { clear(); append( b.data(),    b.size()    ); }
+        inline void     assign                      ( const char  c             )   { clear(); append( &c,          1           ); }
+        inline void     assign                      ( const char* s             )   { clear(); append( s,           strlen( s ) ); }
+        inline void     assign                      ( const char* s, size_t len )   { clear(); append( s,           len         ); }
+        inline void     assign                      ( const std::string& s      )   { clear(); append( s.c_str(),   s.size()    ); }
+        inline void     assign                      ( const std::string_view s  )   { clear(); append( s.data(),    s.size()    ); }
+        inline void     assign                      ( const std::vector<char>& v)   { clear(); append( v.data(),    v.size()    ); }
+
+
+        // append
+        inline void     append                      ( const base_buffer& b      )   { append( b.data(),     b.size()    ); }
+        inline void     append                      ( const char  c             )   { append( &c,           1           ); }
+        inline void     append                      ( const char* s             )   { append( s,            strlen( s ) ); }
+        inline void     append                      ( const std::string& s      )   { append( s.c_str(),    s.size()    ); }
+        inline void     append                      ( const std::string_view s  )   { append( s.data(),     s.size()    ); }
+        inline void     append                      ( const std::vector<char>& v)   { append( v.data(),     v.size()    ); }
+        inline void     append                      ( const char* s, size_t len )
+        {
+            while ( len > 0 )
+            {
+                // only full sized segments are appended to (inserted segments are exact size)
+                if ( segments_.empty() || segments_.back().size() >= segment_capacity() || segments_.back().get_chunk_size() != segment_size_ )
+                    segments_.emplace_back( new_segment() );
+
+                auto& last  = segments_.back();
+                size_t n    = segment_capacity() - last.size();
+                if ( n > len )
+                    n = len;
+
+                last.append( s, n );
+                length_ += n;
+                s       += n;
+                len     -= n;
+            }
+        }
+
+
+        // prepend
+        inline void     prepend                     ( const base_buffer& b      )   { prepend( b.data(),    b.size()    ); }
+        inline void     prepend                     ( const char  c             )   { prepend( &c,          1           ); }
+        inline void     prepend                     ( const char* s             )   { prepend( s,           strlen( s ) ); }
+        inline void     prepend                     ( const std::string& s      )   { prepend( s.c_str(),   s.size()    ); }
+        inline void     prepend                     ( const std::string_view s  )   { prepend( s.data(),    s.size()    ); }
+        inline void     prepend                     ( const std::vector<char>& v)   { prepend( v.data(),    v.size()    ); }
+        inline void     prepend                     ( const char* s, size_t len )   { insert_segments( 0/*index*/, s, len ); }
+
+
+        // insert
+        inline void     insert                      ( size_t from, const base_buffer& b      )  { insert( from, b.data(),   b.size()    ); }
+        inline void     insert                      ( size_t from, const char  c             )  { insert( from, &c,         1           ); }
+        inline void     insert                      ( size_t from, const char* s             )  { insert( from, s,          strlen( s ) ); }
+        inline void     insert                      ( size_t from, const std::string& s      )  { insert( from, s.c_str(),  s.size()    ); }
+        inline void     insert                      ( size_t from, const std::string_view s  )  { insert( from, s.data(),   s.size()    ); }
+        inline void     insert                      ( size_t from, const std::vector<char>& v)  { insert( from, v.data(),   v.size()    ); }
+        inline void     insert                      ( size_t from, const char* s, size_t len )
+        {
+            // insert after the end pads with '\0' like buffer does
+            if ( from >= size() )
+            {
+                if ( from > size() )
+                    resize( from );
+                append( s, len );
+                return;
+            }
+
+            if ( len == 0 )
+                return;
+
+            size_t offset = 0;
+            size_t index  = find_segment( from, &offset );
+            if ( offset > 0 )
+            {
+                // split the segment, the tail goes to a new segment
+                auto& sg = segments_[index];
+                buffer tail( new_segment() );
+                tail.append( sg.data() + offset, sg.size() - offset );
+                sg.resize( offset );
+                segments_.emplace( segments_.begin() + index + 1, std::move( tail ) );
+                ++index;
+            }
+            insert_segments( index, s, len );
+        }
+
+
+        // overwrite / set (like buffer the size becomes from + len)
+        inline void     set                         ( size_t from, const char* s, size_t len ) { erase( from ); insert( from, s, len ); }
+        inline void     set                         ( size_t from, const std::string_view s  ) { set( from, s.data(), s.size() ); }
+        inline void     overwrite                   ( size_t from, const char* s, size_t len ) { set( from, s, len ); }
+        inline void     overwrite                   ( size_t from, const std::string_view s  ) { set( from, s.data(), s.size() ); }
+
+
+        // erase
+        inline void     erase                       ( size_t from )                 { if ( from < size() ) { erase( from, size() - from ); } }
+        inline void     erase                       ( size_t from, size_t length )
+        {
+            if ( from >= size() )
+                return;
+            if ( length > size() - from )
+                length = size() - from;
+
+            size_t offset = 0;
+            size_t index  = find_segment( from, &offset );
+            while ( length > 0 && index < segments_.size() )
+            {
+                auto& sg = segments_[index];
+                size_t n = sg.size() - offset;
+                if ( n > length )
+                    n = length;
+
+                if ( offset == 0 && n == sg.size() )
+                {
+                    // whole segment
+                    segments_.erase( segments_.begin() + index );
+                }
+                else
+                {
+                    sg.erase( offset, n );
+                    ++index;
+                }
+                length_ -= n;
+                length  -= n;
+                offset   = 0;
+            }
+        }
+
+
+        // compare
+        inline bool     is_equal                    ( const char *s, size_t s_length ) const { return size() == s_length && compare( s, s_length ) == 0; }
+        inline int      compare                     ( const char *s, size_t s_length ) const
+        {
+            size_t pos = 0;
+            for ( auto& sg : segments_ )
+            {
+                if ( pos >= s_length )
+                    break;
+                size_t n = sg.size() < s_length - pos ? sg.size() : s_length - pos;
+                int cmp = memcmp( sg.data(), s + pos, n );
+                if ( cmp != 0 )
+                    return cmp;
+                pos += n;
+            }
+            return size() == s_length ? 0 : (size() < s_length ? -1 : 1);
+        }
+
+
+        // [] / at
+        inline char     at                          ( size_t index ) const { size_t offset = 0; size_t i = find_segment( index, &offset ); return segments_[i][offset]; }
+        inline char     operator[]                  ( size_t index ) const { return at( index ); }
+
+
+        // operators
+        inline segmented_buffer& operator+=         ( const base_buffer& b      ) { append( b );        return *this; }
+        inline segmented_buffer& operator+=         ( const char c              ) { append( c );        return *this; }
+        inline segmented_buffer& operator+=         ( const char* s             ) { append( s );        return *this; }
+        inline segmented_buffer& operator+=         ( const std::string& s      ) { append( s );        return *this; }
+        inline segmented_buffer& operator+=         ( const std::string_view s  ) { append( s );        return *this; }
+        inline segmented_buffer& operator+=         ( const std::vector<char>& v) { append( v );        return *this; }
+
+
+    private:
+        // data per segment (keep one byte for '\0' so a full segment is exactly one allocation)
+        inline size_t   segment_capacity            () const { return segment_size_ - 1; }
+
+        // room left in a segment (what is really allocated, up to a whole segment)
+        inline size_t   segment_room                ( const buffer& sg ) const
+        {
+            size_t capacity = sg.capacity() < segment_capacity() ? sg.capacity() : segment_capacity();
+            return capacity > sg.size() ? capacity - sg.size() : 0;
+        }
+
+        // new empty segment
+        inline buffer   new_segment                 () const { return buffer( allocator_, segment_size_ ); }
+
+        // find segment index that contains position (or segments count)
+        inline size_t   find_segment                ( size_t position, size_t* offset ) const
+        {
+            size_t index = 0;
+            for ( ; index < segments_.size(); ++index )
+            {
+                if ( position < segments_[index].size() )
+                    break;
+                position -= segments_[index].size();
+            }
+            *offset = position;
+            return index;
+        }
+
+        // insert new segments before index
+        inline void     insert_segments             ( size_t index, const char* s, size_t len )
+        {
+            std::vector<buffer> inserted;
+            while ( len > 0 )
+            {
+                size_t n = len < segment_capacity() ? len : segment_capacity();
+                buffer sg( allocator_, n + 1 );
+                sg.append( s, n );
+                inserted.emplace_back( std::move( sg ) );
+                length_ += n;
+                s       += n;
+                len     -= n;
+            }
+            segments_.insert( segments_.begin() + index, std::make_move_iterator( inserted.begin() ), std::make_move_iterator( inserted.end() ) );
+        }
+
+
+    private:
+        // segment size
+        size_t              segment_size_;
+        // allocator for segments
+        buffer_allocator*   allocator_;
+        // segments
+        std::deque<buffer>  segments_;
+        // total length
+        size_t              length_{ 0 };
+    };
+
+
+
+    // ==
+    inline bool         operator==                  ( const segmented_buffer& b, const std::string_view s ) { return b.is_equal( s.data(), s.size() ); }
+    inline bool         operator==                  ( const std::string_view s, const segmented_buffer& b ) { return b.is_equal( s.data(), s.size() ); }
+    inline bool         operator!=                  ( const segmented_buffer& b, const std::string_view s ) { return !b.is_equal( s.data(), s.size() ); }
+    inline bool         operator!=                  ( const std::string_view s, const segmented_buffer& b ) { return !b.is_equal( s.data(), s.size() ); }
+}
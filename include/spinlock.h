@@ -21,7 +21,7 @@ namespace small
     class spinlock
     {
     public:
-        spinlock                                    ( const int & spin_count = 4000 ) : /*lock_( ATOMIC_FLAG_INIT ),*/ spin_count_( spin_count ){}
+        spinlock                                    ( const int & spin_count = 4000 ) : spin_count_( spin_count ) { lock_.clear(); } // atomic_flag starts unspecified before c++20
 
         // lock functions
         inline void     lock                        ()
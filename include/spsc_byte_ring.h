@@ -0,0 +1,281 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//
+// lock free ring of bytes for one producer thread and one consumer thread
+//
+// small::spsc_byte_ring ring( 1024 * 1024 );
+// ...
+// // producer thread
+// size_t room = 0;
+// char* p = ring.prepare( &room );     // contiguous room to write
+// size_t n = produce( p, room );
+// ring.commit( n );
+// // or ring.write( data, length );
+// ...
+// // consumer thread
+// size_t available = 0;
+// const char* d = ring.peek( &available );
+// consume( d, available );
+// ring.consume( available );
+// // or ring.read( data, length );
+//
+// with small::EnumRingMode::kRing_Mirror (linux) the memory is mapped twice
+// so prepare and peek always return all the room / data as contiguous
+//
+namespace small
+{
+    // ring memory mode
+    enum class EnumRingMode
+    {
+        kRing_Normal,           // regions stop at the end of the memory (wrap around needs a second call)
+        kRing_Mirror,           // memory is mapped twice one after another so regions are always contiguous
+    };
+
+    // cache line size used to keep head and tail apart
+    const size_t ring_cache_line_size = 64;
+
+
+    // single producer single consumer ring of bytes
+    class spsc_byte_ring
+    {
+    public:
+        // spsc_byte_ring (capacity is rounded up to a power of 2, and to page size in mirror mode)
+        spsc_byte_ring                              ( size_t capacity, EnumRingMode mode = EnumRingMode::kRing_Normal ) { init( capacity, mode ); }
+        ~spsc_byte_ring                             () { free_memory(); }
+
+        spsc_byte_ring                              ( const spsc_byte_ring& ) = delete;
+        spsc_byte_ring&     operator=               ( const spsc_byte_ring& ) = delete;
+
+
+        // capacity / mode
+        inline size_t   capacity                    () const { return capacity_; }
+        inline EnumRingMode get_mode                () const { return mode_; }
+        // valid when memory could be allocated
+        inline bool     is_valid                    () const { return data_ != nullptr; }
+
+
+        // size (approximative when called from other threads)
+        // head is read first so a tail read later is never behind it (head only grows up to tail)
+        inline size_t   size                        () const
+        {
+            size_t head = head_.value.load( std::memory_order_acquire );
+            size_t tail = tail_.value.load( std::memory_order_acquire );
+            size_t used = tail - head;
+            return used <= capacity_ ? used : capacity_;
+        }
+        inline bool     empty                       () const { return size() == 0; }
+        inline size_t   free_size                   () const { return capacity_ - size(); }
+
+
+        //
+        // producer
+        //
+
+        // contiguous room to write (room can be 0 when full)
+        inline char*    prepare                     ( size_t* room )
+        {
+            size_t tail = tail_.value.load( std::memory_order_relaxed );
+            // use cached head and reload it only when it seems full
+            size_t free = capacity_ - (tail - cached_head_);
+            if ( free == 0 )
+            {
+                cached_head_ = head_.value.load( std::memory_order_acquire );
+                free = capacity_ - (tail - cached_head_);
+            }
+
+            size_t offset = tail & mask_;
+            if ( mode_ == EnumRingMode::kRing_Normal && offset + free > capacity_ )
+                free = capacity_ - offset;
+
+            if ( room )
+                *room = free;
+            return data_ + offset;
+        }
+
+        // publish n bytes written in the room given by prepare
+        inline void     commit                      ( size_t n )
+        {
+            tail_.value.store( tail_.value.load( std::memory_order_relaxed ) + n, std::memory_order_release );
+        }
+
+        // write as much as possible (returns bytes written)
+        inline size_t   write                       ( const char* data, size_t length )
+        {
+            size_t written = 0;
+            while ( written < length )
+            {
+                size_t room = 0;
+                char* p = prepare( &room );
+                if ( room == 0 )
+                    break;
+                size_t n = length - written < room ? length - written : room;
+                memcpy( p, data + written, n );
+                commit( n );
+                written += n;
+            }
+            return written;
+        }
+
+
+        //
+        // consumer
+        //
+
+        // contiguous data to read (available can be 0 when empty)
+        inline const char* peek                     ( size_t* available )
+        {
+            size_t head = head_.value.load( std::memory_order_relaxed );
+            // use cached tail and reload it only when it seems empty
+            size_t count = cached_tail_ - head;
+            if ( count == 0 )
+            {
+                cached_tail_ = tail_.value.load( std::memory_order_acquire );
+                count = cached_tail_ - head;
+            }
+
+            size_t offset = head & mask_;
+            if ( mode_ == EnumRingMode::kRing_Normal && offset + count > capacity_ )
+                count = capacity_ - offset;
+
+            if ( available )
+                *available = count;
+            return data_ + offset;
+        }
+
+        // release n bytes read from the data given by peek
+        inline void     consume                     ( size_t n )
+        {
+            head_.value.store( head_.value.load( std::memory_order_relaxed ) + n, std::memory_order_release );
+        }
+
+        // read as much as possible (returns bytes read)
+        inline size_t   read                        ( char* data, size_t length )
+        {
+            size_t done = 0;
+            while ( done < length )
+            {
+                size_t available = 0;
+                const char* p = peek( &available );
+                if ( available == 0 )
+                    break;
+                size_t n = length - done < available ? length - done : available;
+                memcpy( data + done, p, n );
+                consume( n );
+                done += n;
+            }
+            return done;
+        }
+
+
+    private:
+        // round to power of 2
+        static inline size_t round_pow2             ( size_t n ) { size_t p = 1; while ( p < n ) { p <<= 1; } return p; }
+
+        // allocate memory
+        inline void     init                        ( size_t capacity, EnumRingMode mode )
+        {
+            mode_       = mode;
+            capacity_   = round_pow2( capacity > 0 ? capacity : 1 );
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+            if ( mode_ == EnumRingMode::kRing_Mirror && init_mirror() )
+            {
+                mask_ = capacity_ - 1;
+                return;
+            }
+#endif
+            // normal memory (also the fallback for mirror)
+            mode_       = EnumRingMode::kRing_Normal;
+            data_       = (char*)malloc( capacity_ );
+            capacity_   = data_ ? capacity_ : 0;
+            mask_       = capacity_ > 0 ? capacity_ - 1 : 0;
+        }
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+        // map the same memory twice one after another
+        inline bool     init_mirror                 ()
+        {
+            size_t page = (size_t)sysconf( _SC_PAGESIZE );
+            if ( capacity_ < page )
+                capacity_ = page;
+
+            int fd = (int)syscall( SYS_memfd_create, "small_spsc_byte_ring", 0 );
+            if ( fd < 0 )
+                return false;
+
+            bool ok = false;
+            void* base = MAP_FAILED;
+            if ( ftruncate( fd, (off_t)capacity_ ) == 0 )
+            {
+                // reserve address space for 2x then map the memory over both halves
+                base = mmap( nullptr, 2 * capacity_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+                if ( base != MAP_FAILED )
+                {
+                    void* first  = mmap( base,                          capacity_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 );
+                    void* second = mmap( (char*)base + capacity_,       capacity_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 );
+                    ok = first != MAP_FAILED && second != MAP_FAILED;
+                    if ( !ok )
+                        munmap( base, 2 * capacity_ );
+                }
+            }
+            close( fd );
+
+            if ( !ok )
+                return false;
+            data_   = (char*)base;
+            mapped_ = true;
+            return true;
+        }
+#endif
+
+        // free memory
+        inline void     free_memory                 ()
+        {
+#if defined(__linux__)
+            if ( mapped_ )
+            {
+                munmap( data_, 2 * capacity_ );
+                data_ = nullptr;
+                return;
+            }
+#endif
+            free( data_ );
+            data_ = nullptr;
+        }
+
+
+    private:
+        // position padded to its own cache line
+        struct alignas(ring_cache_line_size) position
+        {
+            std::atomic<size_t> value{ 0 };
+        };
+
+        // consumer side
+        position        head_;
+        size_t          cached_tail_{ 0 };      // consumer copy of tail
+        // producer side
+        position        tail_;
+        size_t          cached_head_{ 0 };      // producer copy of head
+
+        // shared read only data
+        alignas(ring_cache_line_size) char* data_{ nullptr };
+        size_t          capacity_{ 0 };
+        size_t          mask_{ 0 };
+        EnumRingMode    mode_{ EnumRingMode::kRing_Normal };
+        bool            mapped_{ false };
+    };
+}